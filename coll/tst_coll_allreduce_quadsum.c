@@ -112,8 +112,10 @@ int tst_coll_allreduce_quadsum_cleanup (struct tst_env * env)
 static void myop_quadsum (void * invec, void * inoutvec, int * len, MPI_Datatype * type)
 {
   int i;
-  long * inbuf = (long *) invec;
-  long * outbuf = (long *) inoutvec;
+  /* The buffers may be shifted off the alignment of long by the buffer offset */
+  char * inbuf = (char *) invec;
+  char * outbuf = (char *) inoutvec;
+  long  in_tmp;
   long  out_tmp;
   if( first_time == NULL)
     {
@@ -121,17 +123,18 @@ static void myop_quadsum (void * invec, void * inoutvec, int * len, MPI_Datatype
     }
   for(i=0; i<(*len); i++)
     {
-      out_tmp = outbuf[i];
+      memcpy (&in_tmp, inbuf + i * sizeof (long), sizeof (long));
+      memcpy (&out_tmp, outbuf + i * sizeof (long), sizeof (long));
       if(first_time[i] == 0)
         {
-            out_tmp = inbuf[i]*inbuf[i] + outbuf[i]*outbuf[i];
+            out_tmp = in_tmp*in_tmp + out_tmp*out_tmp;
             (first_time[i])++;
         }
         else
         {
-            out_tmp = outbuf[i] + inbuf[i] * inbuf[i];
+            out_tmp = out_tmp + in_tmp * in_tmp;
         }
-        outbuf[i] = out_tmp;
+        memcpy (outbuf + i * sizeof (long), &out_tmp, sizeof (long));
     }
   free(first_time);
   first_time = NULL;
@@ -47,7 +47,7 @@ int tst_coll_bcast_run (struct tst_env * env)
       int root;
       tst_type_setstandardarray (env->type, env->values_num, env->send_buffer, i);
 
-      if (tst_comm_getcommclass (env->comm) == TST_MPI_INTRA_COMM)
+      if (tst_comm_getcommclass (env->comm) & TST_MPI_INTRA_COMM)
         root = i;
 #ifdef HAVE_MPI_EXTENDED_COLLECTIVES
       else if (tst_comm_getcommclass (env->comm) == TST_MPI_INTER_COMM)
@@ -0,0 +1,45 @@
+/*
+ * File: tst_comm_cart_create.c
+ *
+ * Functionality:
+ *  Arranges the processes of the communicator in a periodic 2D grid with
+ *  MPI_Cart_create, allowing the MPI library to reorder them to the hardware.
+ *  Measures the cost of the construction in benchmark mode.
+ *  Works with any intra-communicator; the datatype is not used.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_comm.h"
+
+
+int tst_comm_cart_create_init (struct tst_env * env)
+{
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+  return 0;
+}
+
+int tst_comm_cart_create_run (struct tst_env * env)
+{
+  const int periods[2] = {1, 1};
+  int comm_size;
+  MPI_Comm comm;
+  MPI_Comm newcomm;
+
+  /*
+   * With reordering only the size is known.
+   */
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  tst_comm_cart (comm, 2, periods, 1, &newcomm);
+  tst_comm_checkcomm (env, newcomm, comm_size, -1);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+int tst_comm_cart_create_cleanup (struct tst_env * env)
+{
+  (void) env;
+  return 0;
+}
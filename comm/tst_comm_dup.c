@@ -0,0 +1,67 @@
+/*
+ * File: tst_comm_dup.c
+ *
+ * Functionality:
+ *  Duplicates the communicator with MPI_Comm_dup and, as of MPI-3, with its
+ *  nonblocking form MPI_Comm_idup, checking and freeing the duplicate again.
+ *  Measures the cost of the construction in benchmark mode.
+ *  Works with any intra-communicator; the datatype is not used.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_comm.h"
+
+
+int tst_comm_dup_init (struct tst_env * env)
+{
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+  return 0;
+}
+
+/*
+ * The duplicate has the same size and ranks as the communicator.
+ */
+static int tst_comm_dup_check (struct tst_env * env, MPI_Comm newcomm)
+{
+  int comm_size;
+  int comm_rank;
+  MPI_Comm comm;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  return tst_comm_checkcomm (env, newcomm, comm_size, comm_rank);
+}
+
+
+int tst_comm_dup_run (struct tst_env * env)
+{
+  MPI_Comm newcomm;
+
+  MPI_CHECK (MPI_Comm_dup (tst_comm_getcomm (env->comm), &newcomm));
+  tst_comm_dup_check (env, newcomm);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+#if MPI_VERSION >= 3
+int tst_comm_idup_run (struct tst_env * env)
+{
+  MPI_Comm newcomm;
+  MPI_Request request;
+
+  MPI_CHECK (MPI_Comm_idup (tst_comm_getcomm (env->comm), &newcomm, &request));
+  MPI_CHECK (MPI_Wait (&request, MPI_STATUS_IGNORE));
+  tst_comm_dup_check (env, newcomm);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+#endif
+
+int tst_comm_dup_cleanup (struct tst_env * env)
+{
+  (void) env;
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * File: tst_comm_group.c
+ *
+ * Functionality:
+ *  Creates a communicator of all processes in reversed order from their group
+ *  with MPI_Comm_create and, as of MPI-3, with MPI_Comm_create_group, which is
+ *  only collective over the group. The group is set up beforehand, so that
+ *  benchmark mode measures the cost of the construction only.
+ *  Works with any intra-communicator; the datatype is not used.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_comm.h"
+
+
+int tst_comm_group_init (struct tst_env * env)
+{
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  tst_comm_reversed_group (tst_comm_getcomm (env->comm), &env->extra_group);
+  return 0;
+}
+
+/*
+ * The reversed communicator has the same size, the ranks count down.
+ */
+static int tst_comm_group_check (struct tst_env * env, MPI_Comm newcomm)
+{
+  int comm_size;
+  int comm_rank;
+  MPI_Comm comm;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  return tst_comm_checkcomm (env, newcomm, comm_size, comm_size - 1 - comm_rank);
+}
+
+
+int tst_comm_create_run (struct tst_env * env)
+{
+  MPI_Comm newcomm;
+
+  MPI_CHECK (MPI_Comm_create (tst_comm_getcomm (env->comm), env->extra_group, &newcomm));
+  tst_comm_group_check (env, newcomm);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+#if MPI_VERSION >= 3
+int tst_comm_create_group_run (struct tst_env * env)
+{
+  MPI_Comm newcomm;
+
+  MPI_CHECK (MPI_Comm_create_group (tst_comm_getcomm (env->comm), env->extra_group,
+                                    env->tag, &newcomm));
+  tst_comm_group_check (env, newcomm);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+#endif
+
+int tst_comm_group_cleanup (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Group_free (&env->extra_group));
+  return 0;
+}
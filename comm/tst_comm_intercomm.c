@@ -0,0 +1,99 @@
+/*
+ * File: tst_comm_intercomm.c
+ *
+ * Functionality:
+ *  Connects the two halves of the communicator with MPI_Intercomm_create and
+ *  merges the resulting inter-communicator with MPI_Intercomm_merge, checking
+ *  the groups and ranks of the new communicators. The
+ *  halves respectively the inter-communicator are set up beforehand, so that
+ *  benchmark mode measures the cost of the construction only.
+ *  Works with any intra-communicator of at least two processes; the datatype is not used.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_comm.h"
+
+
+int tst_comm_intercomm_init (struct tst_env * env)
+{
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  tst_comm_split_halves (tst_comm_getcomm (env->comm), &env->extra_comm);
+  return 0;
+}
+
+int tst_comm_intercomm_create_run (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  int half;
+  int remote_size;
+  MPI_Comm comm;
+  MPI_Comm newcomm;
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_comm_inter_halves (comm, env->extra_comm, env->tag, &newcomm);
+
+  /*
+   * The local group is the own half, the remote group the other one.
+   */
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Comm_remote_size (newcomm, &remote_size));
+  half = comm_size / 2;
+  if (comm_rank < half)
+    tst_comm_checkcomm (env, newcomm, half, comm_rank);
+  else
+    tst_comm_checkcomm (env, newcomm, comm_size - half, comm_rank - half);
+  if (remote_size != ((comm_rank < half) ? comm_size - half : half))
+    {
+      if (tst_report >= TST_REPORT_FULL)
+        printf ("(Rank:%d) Unexpected remote size %d of the inter-communicator\n",
+                tst_global_rank, remote_size);
+      tst_test_recordfailure (env);
+    }
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+int tst_comm_intercomm_cleanup (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Comm_free (&env->extra_comm));
+  return 0;
+}
+
+
+int tst_comm_intercomm_merge_init (struct tst_env * env)
+{
+  tst_comm_intercomm_init (env);
+  tst_comm_inter_halves (tst_comm_getcomm (env->comm), env->extra_comm, env->tag,
+                         &env->extra_inter_comm);
+  return 0;
+}
+
+int tst_comm_intercomm_merge_run (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  MPI_Comm comm;
+  MPI_Comm newcomm;
+
+  /*
+   * Putting the upper half high restores the order of the communicator.
+   */
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Intercomm_merge (env->extra_inter_comm, comm_rank >= comm_size / 2, &newcomm));
+  tst_comm_checkcomm (env, newcomm, comm_size, comm_rank);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+int tst_comm_intercomm_merge_cleanup (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Comm_free (&env->extra_inter_comm));
+  return tst_comm_intercomm_cleanup (env);
+}
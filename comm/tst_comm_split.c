@@ -0,0 +1,103 @@
+/*
+ * File: tst_comm_split.c
+ *
+ * Functionality:
+ *  Splits the communicator with MPI_Comm_split into few communicators, its two
+ *  halves, and into many communicators, one per pair of processes, and as of
+ *  MPI-3 with MPI_Comm_split_type into the processes sharing memory,
+ *  checking the size of the new communicators and the ranks in them.
+ *  Measures the cost of the construction in benchmark mode.
+ *  Works with any intra-communicator; the datatype is not used.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_comm.h"
+
+
+int tst_comm_split_init (struct tst_env * env)
+{
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+  return 0;
+}
+
+int tst_comm_split_few_run (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  int half;
+  MPI_Comm comm;
+  MPI_Comm newcomm;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  tst_comm_split_halves (comm, &newcomm);
+
+  half = comm_size / 2;
+  if (comm_rank < half)
+    tst_comm_checkcomm (env, newcomm, half, comm_rank);
+  else
+    tst_comm_checkcomm (env, newcomm, comm_size - half, comm_rank - half);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+int tst_comm_split_many_run (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  MPI_Comm comm;
+  MPI_Comm newcomm;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Comm_split (comm, comm_rank / 2, comm_rank, &newcomm));
+
+  /*
+   * The last process is alone for an odd number of processes.
+   */
+  tst_comm_checkcomm (env, newcomm, (comm_rank ^ 1) < comm_size ? 2 : 1, comm_rank % 2);
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+
+#if MPI_VERSION >= 3
+int tst_comm_split_type_run (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  int new_size;
+  int new_rank;
+  MPI_Comm comm;
+  MPI_Comm newcomm;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Comm_split_type (comm, MPI_COMM_TYPE_SHARED, comm_rank, MPI_INFO_NULL, &newcomm));
+
+  /*
+   * The node's share is unknown, ordered by the key the rank however cannot grow.
+   */
+  MPI_CHECK (MPI_Comm_size (newcomm, &new_size));
+  MPI_CHECK (MPI_Comm_rank (newcomm, &new_rank));
+  if (new_size > comm_size || new_rank > comm_rank)
+    {
+      if (tst_report >= TST_REPORT_FULL)
+        printf ("(Rank:%d) Expected shared communicator of at most size %d and rank %d, got size %d with rank %d\n",
+                tst_global_rank, comm_size, comm_rank, new_size, new_rank);
+      tst_test_recordfailure (env);
+    }
+  MPI_CHECK (MPI_Comm_free (&newcomm));
+  return 0;
+}
+#endif
+
+int tst_comm_split_cleanup (struct tst_env * env)
+{
+  (void) env;
+  return 0;
+}
@@ -72,6 +72,30 @@ int get_mpi_info(char *info_str) {
   return 0;
 }
 
+
+#if MPI_VERSION >= 3
+#define MAX_FINGERPRINT_LENGTH (3 * MAX_INFO_STRING_LENGTH + MPI_MAX_LIBRARY_VERSION_STRING)
+#else
+#define MAX_FINGERPRINT_LENGTH (4 * MAX_INFO_STRING_LENGTH)
+#endif
+
+int get_fingerprint( char *info_str, int len, int nprocs ) {
+	char compiler[MAX_INFO_STRING_LENGTH];
+	char mpi[MAX_INFO_STRING_LENGTH];
+#if MPI_VERSION >= 3
+	char library[MPI_MAX_LIBRARY_VERSION_STRING];
+	int library_len;
+	MPI_Get_library_version( library, &library_len );
+#else
+	char library[MAX_INFO_STRING_LENGTH];
+	sprintf( library, "MPI %d.%d", MPI_VERSION, MPI_SUBVERSION );
+#endif
+	get_compiler_info( compiler );
+	get_mpi_info( mpi );
+	snprintf( info_str, len, "%s; %s; %s; %d processes", compiler, mpi, library, nprocs );
+	return 0;
+}
+
 #endif
 
 
@@ -0,0 +1,106 @@
+/*
+ * File: tst_datatype_pack.c
+ *
+ * Functionality:
+ *  Packs the values with MPI_Pack and unpacks them again with MPI_Unpack,
+ *  measuring the throughput of the datatype engine in benchmark mode.
+ *  The reference is a hand-written memcpy gather and scatter of the same layout.
+ *  Works with any C type.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_benchmark.h"
+#include "tst_typemap.h"
+
+
+static int tst_datatype_pack_reference (struct tst_env * env)
+{
+  tst_typemap_gather (env->typemap, env->send_buffer, env->values_num, env->recv_pack_buffer);
+  tst_typemap_scatter (env->typemap, env->recv_pack_buffer, env->values_num, env->reference_buffer);
+  return 0;
+}
+
+
+int tst_datatype_pack_init (struct tst_env * env)
+{
+  int comm_rank;
+  int pack_size;
+  MPI_Comm comm;
+  MPI_Datatype type;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  comm = tst_comm_getcomm (env->comm);
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+
+  env->send_buffer = tst_type_allocvalues (env->type, env->values_num);
+  env->recv_buffer = tst_type_allocvalues (env->type, env->values_num);
+  tst_type_setstandardarray (env->type, env->values_num, env->send_buffer, comm_rank);
+
+  MPI_CHECK (MPI_Pack_size (env->values_num, type, comm, &pack_size));
+  env->pack_size = pack_size;
+  if ((env->send_pack_buffer = malloc (env->pack_size)) == NULL)
+    ERROR (errno, "malloc");
+
+  /*
+   * Only allocated for the reference, freed in any case.
+   */
+  env->recv_pack_buffer = NULL;
+  env->reference_buffer = NULL;
+  if ((env->typemap = malloc (sizeof (struct tst_typemap))) == NULL)
+    ERROR (errno, "malloc");
+  if (tst_typemap_init (env->typemap, type) == 0)
+    {
+      if ((env->recv_pack_buffer = malloc (env->typemap->size * env->values_num + 1)) == NULL)
+        ERROR (errno, "malloc");
+      env->reference_buffer = tst_type_allocvalues (env->type, env->values_num);
+      tst_benchmark_setreference (env, &tst_datatype_pack_reference, "memcpy gather/scatter");
+    }
+  return 0;
+}
+
+int tst_datatype_pack_run (struct tst_env * env)
+{
+  int position = 0;
+  int unpack_position = 0;
+  MPI_Comm comm;
+  MPI_Datatype type;
+
+  comm = tst_comm_getcomm (env->comm);
+  type = tst_type_getdatatype (env->type);
+
+  MPI_CHECK (MPI_Pack (env->send_buffer, env->values_num, type,
+                       env->send_pack_buffer, (int) env->pack_size, &position, comm));
+  MPI_CHECK (MPI_Unpack (env->send_pack_buffer, position, &unpack_position,
+                         env->recv_buffer, env->values_num, type, comm));
+  if (unpack_position != position)
+    ERROR (EINVAL, "Error in position after MPI_Unpack");
+  return 0;
+}
+
+int tst_datatype_pack_cleanup (struct tst_env * env)
+{
+  int comm_rank;
+  MPI_Comm comm;
+
+  /*
+   * Checked once after all iterations, keeping the check out of the timings;
+   * the reference writes to its own buffer, leaving the result of the MPI library.
+   */
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  tst_test_checkstandardarray (env, env->recv_buffer, comm_rank);
+
+  tst_typemap_free (env->typemap);
+  free (env->typemap);
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, env->values_num);
+  if (env->reference_buffer != NULL)
+    tst_type_freevalues (env->type, env->reference_buffer, env->values_num);
+  free (env->send_pack_buffer);
+  free (env->recv_pack_buffer);
+  return 0;
+}
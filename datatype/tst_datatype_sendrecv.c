@@ -0,0 +1,127 @@
+/*
+ * File: tst_datatype_sendrecv.c
+ *
+ * Functionality:
+ *  Ring-communication using MPI_Sendrecv directly with the datatype of the
+ *  values, measuring the throughput of the datatype engine in the
+ *  communication path in benchmark mode. The reference packs the values by
+ *  a hand-written memcpy gather of the same layout, sends them as MPI_BYTE
+ *  and scatters them on the receiver.
+ *  Works with intra-communicators and any C type.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_benchmark.h"
+#include "tst_typemap.h"
+
+
+static void tst_datatype_sendrecv_getpeers (struct tst_env * env, int * send_to, int * recv_from)
+{
+  int comm_size;
+  int comm_rank;
+  MPI_Comm comm;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  *send_to = (comm_rank + 1) % comm_size;
+  *recv_from = (comm_rank + comm_size - 1) % comm_size;
+}
+
+
+static int tst_datatype_sendrecv_reference (struct tst_env * env)
+{
+  int send_to;
+  int recv_from;
+  int bytes;
+  MPI_Comm comm;
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_datatype_sendrecv_getpeers (env, &send_to, &recv_from);
+  bytes = (int) tst_typemap_gather (env->typemap, env->send_buffer, env->values_num, env->send_pack_buffer);
+  MPI_CHECK (MPI_Sendrecv (env->send_pack_buffer, bytes, MPI_BYTE, send_to, env->tag,
+                           env->recv_pack_buffer, bytes, MPI_BYTE, recv_from, env->tag,
+                           comm, MPI_STATUS_IGNORE));
+  tst_typemap_scatter (env->typemap, env->recv_pack_buffer, env->values_num, env->reference_buffer);
+  return 0;
+}
+
+
+int tst_datatype_sendrecv_init (struct tst_env * env)
+{
+  int comm_rank;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+
+  env->send_buffer = tst_type_allocvalues (env->type, env->values_num);
+  env->recv_buffer = tst_type_allocvalues (env->type, env->values_num);
+  tst_type_setstandardarray (env->type, env->values_num, env->send_buffer, comm_rank);
+
+  /*
+   * The layout is the same on all ranks, which therefore all run the reference.
+   * The buffers of the reference are freed in any case.
+   */
+  env->send_pack_buffer = NULL;
+  env->recv_pack_buffer = NULL;
+  env->reference_buffer = NULL;
+  if ((env->typemap = malloc (sizeof (struct tst_typemap))) == NULL)
+    ERROR (errno, "malloc");
+  if (tst_typemap_init (env->typemap, tst_type_getdatatype (env->type)) == 0)
+    {
+      if ((env->send_pack_buffer = malloc (env->typemap->size * env->values_num + 1)) == NULL ||
+          (env->recv_pack_buffer = malloc (env->typemap->size * env->values_num + 1)) == NULL)
+        ERROR (errno, "malloc");
+      env->reference_buffer = tst_type_allocvalues (env->type, env->values_num);
+      tst_benchmark_setreference (env, &tst_datatype_sendrecv_reference, "memcpy gather/scatter with MPI_BYTE");
+    }
+  return 0;
+}
+
+int tst_datatype_sendrecv_run (struct tst_env * env)
+{
+  int send_to;
+  int recv_from;
+  MPI_Comm comm;
+  MPI_Datatype type;
+  MPI_Status status;
+
+  comm = tst_comm_getcomm (env->comm);
+  type = tst_type_getdatatype (env->type);
+  tst_datatype_sendrecv_getpeers (env, &send_to, &recv_from);
+
+  MPI_CHECK (MPI_Sendrecv (env->send_buffer, env->values_num, type, send_to, env->tag,
+                           env->recv_buffer, env->values_num, type, recv_from, env->tag,
+                           comm, &status));
+  if (status.MPI_SOURCE != recv_from || status.MPI_TAG != env->tag)
+    ERROR (EINVAL, "Error in status");
+  return 0;
+}
+
+int tst_datatype_sendrecv_cleanup (struct tst_env * env)
+{
+  int send_to;
+  int recv_from;
+
+  /*
+   * Checked once after all iterations, keeping the check out of the timings;
+   * the reference writes to its own buffer, leaving the result of the MPI library.
+   */
+  tst_datatype_sendrecv_getpeers (env, &send_to, &recv_from);
+  tst_test_checkstandardarray (env, env->recv_buffer, recv_from);
+
+  tst_typemap_free (env->typemap);
+  free (env->typemap);
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, env->values_num);
+  if (env->reference_buffer != NULL)
+    tst_type_freevalues (env->type, env->reference_buffer, env->values_num);
+  free (env->send_pack_buffer);
+  free (env->recv_pack_buffer);
+  return 0;
+}
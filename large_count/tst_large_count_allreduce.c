@@ -0,0 +1,73 @@
+/*
+ * File: tst_large_count_allreduce.c
+ *
+ * Functionality:
+ *  Allreduce test with MPI_MAX like tst_coll_allreduce_max.c, with a number
+ *  of values which may exceed INT_MAX. Uses the MPI-4 large-count functions
+ *  if available; otherwise, as reductions are not defined on derived
+ *  datatypes, the values are reduced in chunks of at most INT_MAX values.
+ *  Works with intra-communicators and the standard C types.
+ */
+#include <limits.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+
+
+int tst_large_count_allreduce_init (struct tst_env * env)
+{
+  int comm_rank;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_count:%lld\n",
+                 tst_global_rank, env->comm, env->type, (long long) env->values_count);
+
+  env->send_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+  env->recv_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  tst_type_setstandardarray_count (env->type, env->values_count, env->send_buffer, comm_rank);
+
+  return 0;
+}
+
+int tst_large_count_allreduce_run (struct tst_env * env)
+{
+  int comm_size;
+#if MPI_VERSION < 4
+  const int type_size = tst_type_gettypesize (env->type);
+  tst_count i;
+  int num;
+#endif
+  MPI_Comm comm;
+  MPI_Datatype type;
+
+  comm = tst_comm_getcomm (env->comm);
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Going to Allreduce\n",
+                 tst_global_rank);
+#if MPI_VERSION >= 4
+  MPI_CHECK (MPI_Allreduce_c (env->send_buffer, env->recv_buffer, env->values_count, type, MPI_MAX, comm));
+#else
+  for (i = 0; i < env->values_count; i += num)
+    {
+      num = (env->values_count - i > INT_MAX) ? INT_MAX : (int) (env->values_count - i);
+      MPI_CHECK (MPI_Allreduce (env->send_buffer + i * type_size, env->recv_buffer + i * type_size,
+                                num, type, MPI_MAX, comm));
+    }
+#endif
+  tst_test_checkstandardarray_count (env, env->recv_buffer, comm_size - 1);
+
+  return 0;
+}
+
+int tst_large_count_allreduce_cleanup (struct tst_env * env)
+{
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, env->values_num);
+  return 0;
+}
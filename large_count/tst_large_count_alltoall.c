@@ -0,0 +1,77 @@
+/*
+ * File: tst_large_count_alltoall.c
+ *
+ * Functionality:
+ *  Alltoall test with a number of values per process which may exceed
+ *  INT_MAX. Uses the MPI-4 large-count functions if available, otherwise
+ *  a derived datatype (see tst_count.h), whose extent covers all values.
+ *  Works with intra-communicators and the standard C types.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_count.h"
+
+
+int tst_large_count_alltoall_init (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  int i;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_count:%lld\n",
+                 tst_global_rank, env->comm, env->type, (long long) env->values_count);
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+
+  env->send_buffer = tst_type_allocvalues_count (env->type, comm_size * env->values_count);
+  env->recv_buffer = tst_type_allocvalues_count (env->type, comm_size * env->values_count);
+
+  for (i = 0; i < comm_size; i++)
+    tst_type_setstandardarray_count (env->type, env->values_count,
+                                     env->send_buffer + i * env->values_count * tst_type_gettypesize (env->type),
+                                     comm_rank);
+  return 0;
+}
+
+int tst_large_count_alltoall_run (struct tst_env * env)
+{
+  int comm_size;
+  int i;
+#if MPI_VERSION < 4
+  int num;
+#endif
+  MPI_Comm comm;
+  MPI_Datatype type;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Going to Alltoall\n",
+                 tst_global_rank);
+#if MPI_VERSION >= 4
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Alltoall_c (env->send_buffer, env->values_count, type,
+                             env->recv_buffer, env->values_count, type, comm));
+#else
+  tst_count_gettype (env->type, env->values_count, &type, &num);
+  MPI_CHECK (MPI_Alltoall (env->send_buffer, num, type, env->recv_buffer, num, type, comm));
+  tst_count_freetype (env->type, &type);
+#endif
+
+  for (i = 0; i < comm_size; i++)
+    tst_test_checkstandardarray_count (env,
+                                       env->recv_buffer + i * env->values_count * tst_type_gettypesize (env->type),
+                                       i);
+  return 0;
+}
+
+int tst_large_count_alltoall_cleanup (struct tst_env * env)
+{
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, env->values_num);
+  return 0;
+}
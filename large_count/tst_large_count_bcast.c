@@ -0,0 +1,69 @@
+/*
+ * File: tst_large_count_bcast.c
+ *
+ * Functionality:
+ *  Broadcast test like tst_coll_bcast.c, with a number of values which may
+ *  exceed INT_MAX. Uses the MPI-4 large-count functions if available,
+ *  otherwise a derived datatype (see tst_count.h).
+ *  Works with intra-communicators and the standard C types.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_count.h"
+
+
+int tst_large_count_bcast_init (struct tst_env * env)
+{
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_count:%lld\n",
+                 tst_global_rank, env->comm, env->type, (long long) env->values_count);
+
+  env->send_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+
+  return 0;
+}
+
+int tst_large_count_bcast_run (struct tst_env * env)
+{
+  int comm_size;
+  int root;
+#if MPI_VERSION < 4
+  int num;
+#endif
+  MPI_Comm comm;
+  MPI_Datatype type;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+
+#if MPI_VERSION >= 4
+  type = tst_type_getdatatype (env->type);
+#else
+  tst_count_gettype (env->type, env->values_count, &type, &num);
+#endif
+
+  for (root = 0; root < comm_size; root++)
+    {
+      tst_type_setstandardarray_count (env->type, env->values_count, env->send_buffer, root);
+
+      tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Going to Bcast with root:%d\n",
+                     tst_global_rank, root);
+#if MPI_VERSION >= 4
+      MPI_CHECK (MPI_Bcast_c (env->send_buffer, env->values_count, type, root, comm));
+#else
+      MPI_CHECK (MPI_Bcast (env->send_buffer, num, type, root, comm));
+#endif
+      tst_test_checkstandardarray_count (env, env->send_buffer, root);
+    }
+
+#if MPI_VERSION < 4
+  tst_count_freetype (env->type, &type);
+#endif
+  return 0;
+}
+
+int tst_large_count_bcast_cleanup (struct tst_env * env)
+{
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * File: tst_large_count_file.c
+ *
+ * Functionality:
+ *  Every process writes its values with MPI_File_write_at into its own part
+ *  of a shared file and reads them back with MPI_File_read_at. The number
+ *  of values may exceed INT_MAX: uses the MPI-4 large-count functions if
+ *  available, otherwise a derived datatype (see tst_count.h).
+ *  Works with intra-communicators and the standard C types.
+ */
+#include "config.h"
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_count.h"
+
+
+#ifdef HAVE_MPI2_IO
+static char file_name[100];
+#endif
+
+int tst_large_count_file_init (struct tst_env * env)
+{
+#ifdef HAVE_MPI2_IO
+  MPI_Comm comm;
+  int comm_rank;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_count:%lld\n",
+                 tst_global_rank, env->comm, env->type, (long long) env->values_count);
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  if (comm_rank == ROOT)
+    {
+      memset (file_name, 0, sizeof (char)*100);
+      sprintf (file_name, "%s%ld", TST_FILE_NAME, (long)getpid());
+    }
+  MPI_CHECK (MPI_Bcast (file_name, 100, MPI_CHAR, ROOT, comm));
+
+  env->send_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+  env->recv_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+  tst_type_setstandardarray_count (env->type, env->values_count, env->send_buffer, comm_rank);
+#endif
+  return 0;
+}
+
+int tst_large_count_file_run (struct tst_env * env)
+{
+#ifdef HAVE_MPI2_IO
+  int comm_rank;
+#if MPI_VERSION < 4
+  int num;
+#endif
+  MPI_Comm comm;
+  MPI_Datatype type;
+  MPI_Datatype count_type;
+  MPI_File file = MPI_FILE_NULL;
+  MPI_Offset offset;
+  MPI_Status status;
+
+  comm = tst_comm_getcomm (env->comm);
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  offset = (MPI_Offset) comm_rank * env->values_count;
+
+  MPI_CHECK (MPI_File_open (comm, file_name, MPI_MODE_CREATE | MPI_MODE_RDWR, MPI_INFO_NULL, &file));
+  if (file == MPI_FILE_NULL)
+    ERROR (EINVAL, "MPI_File_open returned MPI_FILE_NULL");
+  MPI_CHECK (MPI_File_set_view (file, 0, type, type, "native", MPI_INFO_NULL));
+
+#if MPI_VERSION >= 4
+  count_type = type;
+  MPI_CHECK (MPI_File_write_at_c (file, offset, env->send_buffer, env->values_count, count_type, &status));
+  MPI_CHECK (MPI_File_sync (file));
+  MPI_CHECK (MPI_File_read_at_c (file, offset, env->recv_buffer, env->values_count, count_type, &status));
+#else
+  tst_count_gettype (env->type, env->values_count, &count_type, &num);
+  MPI_CHECK (MPI_File_write_at (file, offset, env->send_buffer, num, count_type, &status));
+  MPI_CHECK (MPI_File_sync (file));
+  MPI_CHECK (MPI_File_read_at (file, offset, env->recv_buffer, num, count_type, &status));
+  tst_count_freetype (env->type, &count_type);
+#endif
+  MPI_CHECK (MPI_File_close (&file));
+
+  tst_test_checkstandardarray_count (env, env->recv_buffer, comm_rank);
+#endif
+  return 0;
+}
+
+int tst_large_count_file_cleanup (struct tst_env * env)
+{
+#ifdef HAVE_MPI2_IO
+  MPI_Comm comm;
+  int comm_rank;
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  if (comm_rank == ROOT)
+    MPI_File_delete (file_name, MPI_INFO_NULL);
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, env->values_num);
+#endif
+  return 0;
+}
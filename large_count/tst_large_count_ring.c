@@ -0,0 +1,118 @@
+/*
+ * File: tst_large_count_ring.c
+ *
+ * Functionality:
+ *  Point-to-point ring-communication test like tst_p2p_simple_ring.c, with
+ *  a number of values which may exceed INT_MAX. Uses the MPI-4 large-count
+ *  functions if available, otherwise a derived datatype (see tst_count.h).
+ *  Works with intra-communicators and the standard C types.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_count.h"
+
+
+int tst_large_count_ring_init (struct tst_env * env)
+{
+  int comm_rank;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_count:%lld\n",
+                 tst_global_rank, env->comm, env->type, (long long) env->values_count);
+
+  env->send_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+  env->recv_buffer = tst_type_allocvalues_count (env->type, env->values_count);
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+
+  tst_type_setstandardarray_count (env->type, env->values_count, env->send_buffer, comm_rank);
+
+  return 0;
+}
+
+int tst_large_count_ring_run (struct tst_env * env)
+{
+  int comm_size;
+  int comm_rank;
+  int send_to;
+  int recv_from;
+#if MPI_VERSION < 4
+  int num;
+#endif
+  MPI_Comm comm;
+  MPI_Datatype type;
+  MPI_Status status;
+
+  comm = tst_comm_getcomm (env->comm);
+
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  if (comm_size > 1)
+    {
+      send_to = (comm_rank + 1) % comm_size;
+      recv_from = (comm_rank + comm_size - 1) % comm_size;
+    }
+  else
+    {
+      send_to = MPI_PROC_NULL;
+      recv_from = MPI_PROC_NULL;
+    }
+
+#if MPI_VERSION >= 4
+  type = tst_type_getdatatype (env->type);
+  if (comm_rank == 0)
+    {
+      MPI_CHECK (MPI_Send_c (env->send_buffer, env->values_count, type, send_to, env->tag, comm));
+      MPI_CHECK (MPI_Recv_c (env->recv_buffer, env->values_count, type, recv_from, env->tag, comm, &status));
+    }
+  else
+    {
+      MPI_CHECK (MPI_Recv_c (env->recv_buffer, env->values_count, type, recv_from, env->tag, comm, &status));
+      MPI_CHECK (MPI_Send_c (env->send_buffer, env->values_count, type, send_to, env->tag, comm));
+    }
+#else
+  tst_count_gettype (env->type, env->values_count, &type, &num);
+  if (comm_rank == 0)
+    {
+      MPI_CHECK (MPI_Send (env->send_buffer, num, type, send_to, env->tag, comm));
+      MPI_CHECK (MPI_Recv (env->recv_buffer, num, type, recv_from, env->tag, comm, &status));
+    }
+  else
+    {
+      MPI_CHECK (MPI_Recv (env->recv_buffer, num, type, recv_from, env->tag, comm, &status));
+      MPI_CHECK (MPI_Send (env->send_buffer, num, type, send_to, env->tag, comm));
+    }
+#endif
+
+  if (status.MPI_SOURCE != recv_from)
+    ERROR (EINVAL, "Error in status");
+
+  if (recv_from != MPI_PROC_NULL)
+    {
+#if MPI_VERSION >= 3
+      if (tst_mode == TST_MODE_STRICT)
+        {
+          MPI_Count recv_count;
+          MPI_CHECK (MPI_Get_elements_x (&status, type, &recv_count));
+          if (recv_count != env->values_count)
+            ERROR (EINVAL, "Error in count");
+        }
+#endif
+      tst_test_checkstandardarray_count (env, env->recv_buffer, recv_from);
+    }
+
+#if MPI_VERSION < 4
+  tst_count_freetype (env->type, &type);
+#endif
+  return 0;
+}
+
+int tst_large_count_ring_cleanup (struct tst_env * env)
+{
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, env->values_num);
+
+  return 0;
+}
@@ -10,6 +10,16 @@
 #include "tst_comm.h"
 #include "tst_threads.h"
 #include "tst_output.h"
+#include "tst_benchmark.h"
+#include "tst_values.h"
+#include "tst_plan.h"
+#include "tst_watchdog.h"
+#include "tst_journal.h"
+#include "tst_cache.h"
+#include "tst_bisect.h"
+#include "tst_pool.h"
+#include "tst_typegen.h"
+#include "tst_verify.h"
 #include "compile_info.h"
 
 #include "cmdline.h"
@@ -48,6 +58,9 @@ const char * tst_modes[] = {
 /* Upper limit for the tag defined in the MPI-2.1 p.28 and MPI-2.1 8.1.2. */
 static int tst_tag_ub = 32767;
 
+/* Number of entries of the plan whose results are combined in one reduction */
+#define TST_RECORD_BATCH 64
+
 
 /****************************************************************************/
 /**                                                                        **/
@@ -57,9 +70,11 @@ static int tst_tag_ub = 32767;
 
 int tst_hash_value (const struct tst_env * env)
 {
-  return (env->comm * 65521 + /* Smallest prime smaller than 2^16 */
-          env->type * 32749  + /* Smallest prime smaller than 2^16 */
-          env->test) % tst_tag_ub;
+  /*
+   * The tag of the environment is unique for every test of the plan,
+   * unlike a hash of comm, type and test, which collides.
+   */
+  return env->tag;
 }
 
 /** \brief Compress array, by removing all -1 entries
@@ -83,6 +98,32 @@ static int tst_array_compress(int *list, const int list_max, int *list_num) {
   return current_pos;
 }
 
+/** \brief Combine the results of finished entries of the plan over all ranks
+ *
+ * One reduction on MPI_COMM_WORLD yields for all entries whether they failed
+ * on any rank, which is recorded in the journal and the cache.
+ *
+ * \param[in]     first   index of the first entry in the plan
+ * \param[in,out] failed  per entry non-zero if it failed on the calling rank,
+ *                        on return non-zero if it failed on any rank
+ * \param[in]     num     number of entries
+ */
+static void tst_record_results (int first, int * failed, int num)
+{
+  struct tst_env env;
+  int i;
+
+  if (num == 0)
+    return;
+  MPI_CHECK (MPI_Allreduce (MPI_IN_PLACE, failed, num, MPI_INT, MPI_MAX, MPI_COMM_WORLD));
+  for (i = 0; i < num; i++)
+    {
+      tst_plan_getenv (first + i, &env);
+      tst_journal_record (&env, failed[i]);
+      tst_cache_record (&env, failed[i]);
+    }
+}
+
 
 
 
@@ -95,13 +136,20 @@ int main (int argc, char * argv[])
   }
 
 
-  int i, j, k, l;
+  int i;
+  int num_plan;
+  int tag_range = 1;
+  int failure_events;
+  int failed[TST_RECORD_BATCH];
+  int failed_num = 0;
+  int record;
+  int record_batch;
   int flag;
 
   int num_comms = 0;
   int num_types = 0;
   int num_tests = 0;
-  int num_num_values = 1;
+  int num_num_values = 0;
   struct tst_env tst_env;
   int * tst_test_array;
   int tst_test_array_max;
@@ -109,13 +157,13 @@ int main (int argc, char * argv[])
   int tst_comm_array_max;
   int * tst_type_array;
   int tst_type_array_max;
-  int tst_value_array[32];
-  int tst_value_array_max = 32;
   int * val;
   double time_start, time_stop;
 #ifdef HAVE_MPI2_THREADS
   int num_threads = 0;
   int tst_thread_level_provided;
+#elif MPI_VERSION >= 2
+  int tst_watchdog_level_provided;
 #endif
 
 
@@ -133,6 +181,14 @@ int main (int argc, char * argv[])
       tst_thread_level_provided = MPI_THREAD_SINGLE;
     }
 
+#elif MPI_VERSION >= 2
+  /*
+   * The watchdog thread aborts the job while the main thread hangs in MPI.
+   */
+  if (args_info.timeout_arg > 0 || args_info.timeouts_given)
+    MPI_Init_thread (&argc, &argv, MPI_THREAD_MULTIPLE, &tst_watchdog_level_provided);
+  else
+    MPI_Init (&argc, &argv);
 #else
   MPI_Init (&argc, &argv);
 #endif
@@ -183,6 +239,8 @@ int main (int argc, char * argv[])
 
   /* XXX CN Maybe rename these functions to tst_get_num_comms/types/tests ?  */
   tst_comm_array_max = tst_comms_register();
+  if (args_info.datatype_spec_given)
+    tst_typegen_parse (args_info.datatype_spec_arg);
   tst_type_init(&tst_type_array_max);
   tst_test_init(&tst_test_array_max);
 
@@ -210,9 +268,6 @@ int main (int argc, char * argv[])
   for (i = 0; i < tst_type_array_max; i++) {
     tst_type_array[i] = -1;
   }
-  for (i = 0; i < tst_value_array_max; i++) {
-    tst_value_array[i] = 0;
-  }
 
 
   /* just list tests, comms, ... and exit */
@@ -231,6 +286,15 @@ int main (int argc, char * argv[])
     exit (0);
   }
 
+  /* just merge the journals of shards and exit */
+  if (args_info.merge_given) {
+    int num_failed = 0;
+    if (!tst_global_rank)
+      num_failed = tst_journal_merge (args_info.merge_arg);
+    MPI_Finalize ();
+    exit (num_failed > 0 ? -1 : 0);
+  }
+
   char *str;
   /*
    * select tests
@@ -350,14 +414,7 @@ int main (int argc, char * argv[])
   /*
    * fill list of number of values
    */
-  num_num_values = 0;
-  str = strtok (args_info.num_values_arg, ",");
-  while (str) {
-    tst_value_array[num_num_values++] = atoi (str);
-    if (num_num_values >= tst_value_array_max)
-      ERROR (EINVAL, "Too many values specified");
-    str = strtok (NULL, ",");
-  }
+  num_num_values = tst_values_init (args_info.num_values_arg);
 
   for (tst_report = TST_REPORT_NONE; tst_report < TST_REPORT_MAX; tst_report++) {
     if (0 == strcasecmp (args_info.report_arg, tst_reports[tst_report])) {
@@ -390,81 +447,166 @@ int main (int argc, char * argv[])
       tst_atomic = 1;
   }
 
+  tst_pool_init (strcasecmp (args_info.buffer_pool_arg, "off") ? TST_POOL_ON : TST_POOL_OFF,
+                 args_info.buffer_placement_arg, args_info.buffer_offset_arg);
+  if (args_info.golden_cache_arg < 0)
+    ERROR (EINVAL, "Memory budget of the cache of expected arrays must not be negative");
+  tst_verify_init (strcasecmp (args_info.verify_arg, "hash") ? TST_VERIFY_FULL : TST_VERIFY_HASH,
+                   (size_t) args_info.golden_cache_arg << 20);
+  tst_verify_setmismatch (args_info.mismatch_ranges_arg,
+                          args_info.mismatch_dump_given ? args_info.mismatch_dump_arg : NULL);
+  tst_comm_setdegree (args_info.graph_degree_arg);
+  tst_benchmark_init (args_info.benchmark_arg, args_info.warmup_arg);
+  tst_watchdog_init (args_info.timeout_arg, args_info.timeouts_given ? args_info.timeouts_arg : NULL);
+
 #ifdef HAVE_MPI2_THREADS
   if (num_threads <= 0) {
     printf ("Error: Number of threads must be greater than 0 (given %d)\n", num_threads);
     MPI_Abort(MPI_COMM_WORLD, 1);
   }
   tst_thread_init (num_threads, &tst_thread_env);
+  tag_range = num_threads;
 #endif
 
-  num_comms = tst_comms_init();
+  tst_comms_init(tst_comm_array, num_comms);
   /*
-   * For every test included in the tst_*_array, check if runnable and run!
+   * Plan every runnable combination of the tests included in the tst_*_array, then run the plan!
    */
   tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "num_tests:%d num_comms:%d num_types:%d\n",
                      num_tests, num_comms, num_types);
 
-  for (i = 0; i < num_tests; i++)
-    for (j = 0; j < num_comms; j++)
-      for (k = 0; k < num_types; k++)
-        for (l = 0; l < num_num_values; l++)
-          {
-            /*
-             * Before setting the mandatory first fields needed, reset.
-             * Every test should clean up after itself.
-             */
-            memset (&tst_env, 0, sizeof (tst_env));
-            tst_env.test        = tst_test_array[i];
-            tst_env.values_num  = tst_value_array[l];
-            tst_env.type        = tst_type_array[k];
-            tst_env.tag         = (i+j+k+l) % tst_tag_ub;
-            tst_env.comm        = tst_comm_array[j];
-            double time_curr = MPI_Wtime ();
-            tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "(Rank:%d) starting test_env.test:%d at time %f\n",
-                     tst_global_rank, tst_env.test, time_curr - time_start);
-
-            if (!tst_test_check_run (&tst_env))
-              {
-                tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "Not running tst_env.test:%d\n", tst_env.test);
-                continue;
-              }
-
-            fflush (stderr);
-            fflush (stdout);
-            if (tst_test_check_sync (&tst_env))
-              MPI_Barrier (MPI_COMM_WORLD);
-
-            if (tst_global_rank == 0 && tst_report >= TST_REPORT_RUN)
-              printf ("%s tests %s (%d/%d), comm %s (%d/%d), type %s (%d/%d)\n",
-                      tst_test_getclass_string (tst_env.test),
-                      tst_test_getdescription (tst_env.test), tst_env.test+1, num_tests,
-                      tst_comm_getdescription (tst_env.comm), tst_env.comm+1, num_comms,
-                      tst_type_getdescription (tst_env.type), tst_env.type+1, num_types);
+  num_plan = tst_plan_init (tst_test_array, num_tests, tst_comm_array, num_comms,
+                            tst_type_array, num_types, num_num_values, tst_pool_getoffsets_num (),
+                            tst_tag_ub, tag_range, args_info.concurrent_given);
+
+  if (!strcasecmp (args_info.coverage_arg, "pairwise"))
+    num_plan = tst_plan_cover (2);
+  else if (!strcasecmp (args_info.coverage_arg, "3-wise"))
+    num_plan = tst_plan_cover (3);
+
+  if (args_info.shard_given)
+    {
+      int shard;
+      int num_shards;
+      if (sscanf (args_info.shard_arg, "%d/%d", &shard, &num_shards) != 2)
+        ERROR (EINVAL, "Shard has to be specified as k/n");
+      num_plan = tst_plan_shard (shard, num_shards);
+    }
+
+  if (args_info.resume_given)
+    num_plan -= tst_journal_resume (args_info.resume_arg);
+
+  if (args_info.cache_given)
+    {
+      char fingerprint[MAX_FINGERPRINT_LENGTH];
+      size_t len;
+      get_fingerprint (fingerprint, sizeof (fingerprint), tst_global_size);
+      /*
+       * The settings changing what the tests check are part of the fingerprint.
+       */
+      len = strlen (fingerprint);
+      snprintf (fingerprint + len, sizeof (fingerprint) - len, "; %s mode; %d threads; %s verification",
+                tst_modes[tst_mode], args_info.num_threads_arg, args_info.verify_arg);
+      num_plan -= tst_cache_init (args_info.cache_arg, fingerprint, args_info.force_given);
+    }
+
+  if (args_info.dry_run_given)
+    {
+      tst_plan_print ();
+      num_plan = 0;
+    }
+  else if (args_info.journal_given)
+    tst_journal_init (args_info.journal_arg);
+  else if (args_info.resume_given)
+    tst_journal_init (args_info.resume_arg);
+
+  /*
+   * Bisection needs the result of every test right away, the journal and the cache only eventually.
+   */
+  record = args_info.journal_given || args_info.resume_given || args_info.cache_given || args_info.bisect_given;
+  record_batch = args_info.bisect_given ? 1 : TST_RECORD_BATCH;
+
+  for (i = 0; i < num_plan; i++)
+    {
+      tst_plan_getenv (i, &tst_env);
+      tst_pool_setoffset (tst_env.buffer_offset);
+      tst_verify_settuple (&tst_env);
+      double time_curr = MPI_Wtime ();
+      tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "(Rank:%d) starting test_env.test:%d at time %f\n",
+                         tst_global_rank, tst_env.test, time_curr - time_start);
+
+      fflush (stderr);
+      fflush (stdout);
+      tst_plan_barrier (i);
+      tst_watchdog_start (&tst_env);
+      failure_events = tst_test_get_failure_events ();
+
+      if (tst_global_rank == 0 && tst_report >= TST_REPORT_RUN)
+        printf ("%s tests %s (%d/%d), comm %s (%d/%d), type %s (%d/%d), buffer offset %d\n",
+                tst_test_getclass_string (tst_env.test),
+                tst_test_getdescription (tst_env.test), tst_env.test+1, num_tests,
+                tst_comm_getdescription (tst_env.comm), tst_env.comm+1, num_comms,
+                tst_type_getdescription (tst_env.type), tst_env.type+1, num_types,
+                tst_env.buffer_offset);
+#ifdef HAVE_MPI2_THREADS
+      if (num_threads > 0)
+        {
+          tst_thread_assign_all (&tst_env, tst_thread_env);
+          tst_thread_execute_init (&tst_env);
+          if (tst_benchmark_enabled ())
+            tst_benchmark_run (&tst_env, &tst_thread_execute_run, tst_test_check_aggregate (&tst_env));
+          else
+            tst_thread_execute_run (&tst_env);
+          tst_thread_execute_cleanup (&tst_env);
+        }
+      else
+#endif
+      if (tst_benchmark_enabled () && tst_test_getclass (tst_env.test) == TST_CLASS_COMM)
+        tst_benchmark_sweep (&tst_env);
+      else
+        {
+          tst_test_init_func (&tst_env);
+          if (tst_benchmark_enabled ())
+            tst_benchmark_run (&tst_env, &tst_test_run_func, tst_test_check_aggregate (&tst_env));
+          else
+            tst_test_run_func (&tst_env);
+          tst_test_cleanup_func (&tst_env);
+        }
+      tst_watchdog_stop ();
+      if (!record)
+        continue;
+      /*
+       * The failed list merges repeated failures of the same entry, count the failure events instead.
+       */
+      failed[failed_num++] = tst_test_get_failure_events () > failure_events;
+      if (failed_num < record_batch)
+        continue;
+      tst_record_results (i + 1 - failed_num, failed, failed_num);
+      failed_num = 0;
+
+      if (args_info.bisect_given && failed[0])
 #ifdef HAVE_MPI2_THREADS
-            if (num_threads > 0)
-              {
-                tst_thread_assign_all (&tst_env, tst_thread_env);
-                tst_thread_execute_init (&tst_env);
-                tst_thread_execute_run (&tst_env);
-                tst_thread_execute_cleanup (&tst_env);
-              }
-            else
+        tst_bisect (&tst_env, num_threads > 0 ? tst_thread_env : NULL);
 #else
-              {
-                tst_test_init_func (&tst_env);
-                tst_test_run_func (&tst_env);
-                tst_test_cleanup_func (&tst_env);
-              }
+        tst_bisect (&tst_env, NULL);
 #endif
-            if (tst_test_check_sync (&tst_env))
-              MPI_Barrier (MPI_COMM_WORLD);
-          }
+    }
+  tst_record_results (num_plan - failed_num, failed, failed_num);
+  tst_plan_barrier (num_plan);
 
   if (tst_global_rank == 0 && tst_report >= TST_REPORT_SUMMARY) {
     tst_test_print_failed ();
   }
 
+  tst_cache_cleanup ();
+  tst_journal_cleanup ();
+  tst_watchdog_cleanup ();
+  tst_benchmark_cleanup ();
+  tst_plan_cleanup ();
+  tst_values_cleanup ();
+  tst_verify_cleanup ();
+  tst_pool_cleanup ();
+
   time_stop = MPI_Wtime ();
   tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "(Rank:%d) Overall time taken:%lf\n",
                      tst_global_rank, time_stop - time_start);
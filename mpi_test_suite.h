@@ -73,6 +73,15 @@
 #  error "No 8-Byte integer found"
 #endif
 
+/*
+ * Number of values of the large-count tests, which may exceed INT_MAX.
+ */
+#if MPI_VERSION >= 3
+#  define tst_count MPI_Count
+#else
+#  define tst_count tst_int64
+#endif
+
 #define TST_DESCRIPTION_LEN 48
 
 #define TST_SUCESS 0
@@ -95,6 +104,9 @@
 #define TST_MPI_CART_COMM  16 /* Same for these */
 #define TST_MPI_TOPO_COMM  32 /* Same for these */
 #define TST_MPI_SHARED_COMM 64 /* Same for these */
+#define TST_MPI_HW_COMM    128 /* Split by a hardware resource within a node */
+#define TST_MPI_INTER_NODE_COMM 256 /* At most one process per node */
+#define TST_MPI_DIST_GRAPH_COMM 512 /* Built with MPI_Dist_graph_create_adjacent */
 
 /*
  * Definition of the internal representations for the test classes
@@ -107,6 +119,10 @@
 #define TST_CLASS_DYNAMIC    16
 #define TST_CLASS_IO         32
 #define TST_CLASS_THREADED   64
+#define TST_CLASS_LARGE_COUNT 128
+#define TST_CLASS_DATATYPE  256
+#define TST_CLASS_NEIGHBOR  512
+#define TST_CLASS_COMM     1024
 
 #define ROOT 0
 
@@ -157,6 +173,7 @@
 #define TST_MPI_TYPE_MIX          ((tst_uint64)0x1 << 39)
 #define TST_MPI_TYPE_MIX_ARRAY    ((tst_uint64)0x1 << 40)
 #define TST_MPI_TYPE_MIX_LB_UB    ((tst_uint64)0x1 << 41)
+#define TST_MPI_TYPE_GENERATED    ((tst_uint64)0x1 << 42)
 
 #ifdef HAVE_MPI2
   /*
@@ -224,7 +241,8 @@
 #define TST_MPI_DERIVED_MIXED_TYPES \
   (TST_MPI_TYPE_MIX | \
    TST_MPI_TYPE_MIX_ARRAY | \
-   TST_MPI_TYPE_MIX_LB_UB)
+   TST_MPI_TYPE_MIX_LB_UB | \
+   TST_MPI_TYPE_GENERATED)
 
 
 #define TST_MPI_STANDARD_FORTRAN_INT_TYPES TST_MPI_INTEGER
@@ -267,6 +285,12 @@
 #define TST_NONE 0
 #define TST_SYNC 1
 
+/*
+ * Timing in benchmark mode, synchronized tests are always aggregated
+ */
+#define TST_BENCH_RANK 0
+#define TST_BENCH_AGGREGATE 1
+
 
 /****************************************************************************/
 /**                                                                        **/
@@ -274,12 +298,16 @@
 /**                                                                        **/
 /****************************************************************************/
 
+struct tst_typemap;
+
 struct tst_env {
   int test;
   int values_num;
+  tst_count values_count;       /* Number of values of the large-count tests, otherwise values_num */
   int type;
   int tag;
   int comm;
+  int buffer_offset;
   char * send_buffer;
   char * send_pack_buffer;
   char * recv_buffer;
@@ -294,12 +322,21 @@ struct tst_env {
   char * check_buffer;
   int * cancelled;
   MPI_Datatype extra_type_send;
+  MPI_Comm extra_comm;
+  MPI_Comm extra_inter_comm;
+  MPI_Group extra_group;
   int position;
   int * send_to;
   int * recv_from;
   int * send_counts;
   int * send_displs;
   char * read_buffer;
+  char * reference_buffer;      /* Output of the reference in benchmark mode, apart from the one checked */
+  struct tst_typemap * typemap; /* Layout of the datatype copied by the reference */
+  MPI_Aint * send_byte_displs;  /* Displacements in bytes of the alltoallw tests */
+  MPI_Aint * recv_byte_displs;
+  MPI_Datatype * send_types;    /* Datatype per block of the alltoallw tests */
+  MPI_Aint pack_size;           /* Size of the buffer the values are packed into */
 };
 
 struct tst_mpi_float_int {
@@ -396,6 +433,7 @@ extern int tst_comm_cleanup (void);
 extern MPI_Comm tst_comm_getcomm (int comm);
 extern int tst_comm_getcommclass (int comm);
 extern int tst_comm_getcommsize (int comm);
+extern int tst_comm_getminsize (int comm);
 extern const char * tst_comm_getdescription (int comm);
 extern void tst_comm_list (void);
 extern int tst_comm_select (const char * comm_string,
@@ -405,7 +443,7 @@ extern int tst_comm_deselect (const char * comm_string,
 
 extern int tst_test_init (int * num_tests);
 extern int tst_test_cleanup (void);
-extern const char * tst_test_getclass (int i);
+extern int tst_test_getclass (int i);
 extern const char * tst_test_getclass_string(int i);
 extern const char * tst_test_getdescription (int i);
 extern int tst_test_getmode (int i);
@@ -417,6 +455,7 @@ void *  tst_test_get_run_func (struct tst_env * env);
 void *  tst_test_get_cleanup_func (struct tst_env * env);
 extern int tst_test_check_run (struct tst_env * env);
 extern int tst_test_check_sync (struct tst_env * env);
+extern int tst_test_check_aggregate (struct tst_env * env);
 extern void tst_test_list (void);
 extern int tst_test_select (const char * test_string,
                             int * test_list, const int test_list_max, int * test_list_num);
@@ -426,10 +465,15 @@ extern int tst_test_deselect (const char * test_string,
 extern int tst_test_checkstandardarray (const struct tst_env * env,
                                         char * buffer,
                                         int comm_rank);
+extern int tst_test_checkstandardarray_count (const struct tst_env * env,
+                                              char * buffer,
+                                              int comm_rank);
 extern int tst_test_is_empty_status (MPI_Status * status);
 extern int tst_test_recordfailure (const struct tst_env * env);
 extern int tst_test_print_failed (void);
 extern int tst_test_get_failed_num (void);
+extern int tst_test_suppress_failures (int suppress);
+extern int tst_test_get_failure_events (void);
 
 
 extern int tst_type_init (int * num_types);
@@ -446,10 +490,13 @@ extern void tst_type_hexdump (const char * text, const char * data, int num);
 extern int tst_type_setvalue (int type, char * buffer, int mode, long long direct_value);
 extern int tst_type_cmpvalue (int type, const char * buffer1, const char * buffer2);
 extern char * tst_type_allocvalues (const int type, const int values_num);
+extern char * tst_type_allocvalues_count (const int type, const tst_count values_count);
 extern int tst_type_freevalues (const int type, char * buffer, const int values_num);
 extern int tst_type_checkstandardarray (int type, int values_num, char * buffer, int comm_rank);
 extern int tst_type_setstandardarray (int type, int values_num, char * buffer, int comm_rank);
-extern int tst_type_getstandardarray_size (int type, int values_num, MPI_Aint * size);
+extern int tst_type_checkstandardarray_count (int type, tst_count values_count, char * buffer, int comm_rank);
+extern int tst_type_setstandardarray_count (int type, tst_count values_count, char * buffer, int comm_rank);
+extern int tst_type_getstandardarray_size (int type, tst_count values_count, tst_count * size);
 extern void tst_type_list (void);
 extern int tst_type_select (const char * type_string,
                             int * type_list, const int type_list_max, int * type_list_num);
@@ -928,4 +975,107 @@ extern int tst_threaded_ring_partitioned_many_to_one_cleanup (struct tst_env * e
 
 #endif
 
+/*
+ * Large-count tests
+ */
+extern int tst_large_count_ring_init (struct tst_env * env);
+extern int tst_large_count_ring_run (struct tst_env * env);
+extern int tst_large_count_ring_cleanup (struct tst_env * env);
+
+extern int tst_large_count_alltoall_init (struct tst_env * env);
+extern int tst_large_count_alltoall_run (struct tst_env * env);
+extern int tst_large_count_alltoall_cleanup (struct tst_env * env);
+
+extern int tst_large_count_bcast_init (struct tst_env * env);
+extern int tst_large_count_bcast_run (struct tst_env * env);
+extern int tst_large_count_bcast_cleanup (struct tst_env * env);
+
+extern int tst_large_count_allreduce_init (struct tst_env * env);
+extern int tst_large_count_allreduce_run (struct tst_env * env);
+extern int tst_large_count_allreduce_cleanup (struct tst_env * env);
+
+extern int tst_large_count_file_init (struct tst_env * env);
+extern int tst_large_count_file_run (struct tst_env * env);
+extern int tst_large_count_file_cleanup (struct tst_env * env);
+
+/*
+ * Datatype tests
+ */
+extern int tst_datatype_pack_init (struct tst_env * env);
+extern int tst_datatype_pack_run (struct tst_env * env);
+extern int tst_datatype_pack_cleanup (struct tst_env * env);
+
+extern int tst_datatype_pack_external_init (struct tst_env * env);
+extern int tst_datatype_pack_external_run (struct tst_env * env);
+extern int tst_datatype_pack_external_cleanup (struct tst_env * env);
+
+extern int tst_datatype_sendrecv_init (struct tst_env * env);
+extern int tst_datatype_sendrecv_run (struct tst_env * env);
+extern int tst_datatype_sendrecv_cleanup (struct tst_env * env);
+
+/*
+ * Neighborhood collective tests
+ */
+extern int tst_neighbor_allgather_init (struct tst_env * env);
+extern int tst_neighbor_allgather_run (struct tst_env * env);
+extern int tst_neighbor_iallgather_run (struct tst_env * env);
+extern int tst_neighbor_allgather_cleanup (struct tst_env * env);
+extern int tst_neighbor_allgather_persistent_init (struct tst_env * env);
+extern int tst_neighbor_allgather_persistent_run (struct tst_env * env);
+extern int tst_neighbor_allgather_persistent_cleanup (struct tst_env * env);
+
+extern int tst_neighbor_alltoall_init (struct tst_env * env);
+extern int tst_neighbor_alltoall_run (struct tst_env * env);
+extern int tst_neighbor_ialltoall_run (struct tst_env * env);
+extern int tst_neighbor_alltoall_cleanup (struct tst_env * env);
+extern int tst_neighbor_alltoall_persistent_init (struct tst_env * env);
+extern int tst_neighbor_alltoall_persistent_run (struct tst_env * env);
+extern int tst_neighbor_alltoall_persistent_cleanup (struct tst_env * env);
+
+extern int tst_neighbor_alltoallv_init (struct tst_env * env);
+extern int tst_neighbor_alltoallv_run (struct tst_env * env);
+extern int tst_neighbor_ialltoallv_run (struct tst_env * env);
+extern int tst_neighbor_alltoallv_cleanup (struct tst_env * env);
+extern int tst_neighbor_alltoallv_persistent_init (struct tst_env * env);
+extern int tst_neighbor_alltoallv_persistent_run (struct tst_env * env);
+extern int tst_neighbor_alltoallv_persistent_cleanup (struct tst_env * env);
+
+extern int tst_neighbor_alltoallw_init (struct tst_env * env);
+extern int tst_neighbor_alltoallw_run (struct tst_env * env);
+extern int tst_neighbor_ialltoallw_run (struct tst_env * env);
+extern int tst_neighbor_alltoallw_cleanup (struct tst_env * env);
+extern int tst_neighbor_alltoallw_persistent_init (struct tst_env * env);
+extern int tst_neighbor_alltoallw_persistent_run (struct tst_env * env);
+extern int tst_neighbor_alltoallw_persistent_cleanup (struct tst_env * env);
+
+/*
+ * Communicator construction tests
+ */
+extern int tst_comm_dup_init (struct tst_env * env);
+extern int tst_comm_dup_run (struct tst_env * env);
+extern int tst_comm_idup_run (struct tst_env * env);
+extern int tst_comm_dup_cleanup (struct tst_env * env);
+
+extern int tst_comm_split_init (struct tst_env * env);
+extern int tst_comm_split_few_run (struct tst_env * env);
+extern int tst_comm_split_many_run (struct tst_env * env);
+extern int tst_comm_split_type_run (struct tst_env * env);
+extern int tst_comm_split_cleanup (struct tst_env * env);
+
+extern int tst_comm_group_init (struct tst_env * env);
+extern int tst_comm_create_run (struct tst_env * env);
+extern int tst_comm_create_group_run (struct tst_env * env);
+extern int tst_comm_group_cleanup (struct tst_env * env);
+
+extern int tst_comm_intercomm_init (struct tst_env * env);
+extern int tst_comm_intercomm_create_run (struct tst_env * env);
+extern int tst_comm_intercomm_cleanup (struct tst_env * env);
+extern int tst_comm_intercomm_merge_init (struct tst_env * env);
+extern int tst_comm_intercomm_merge_run (struct tst_env * env);
+extern int tst_comm_intercomm_merge_cleanup (struct tst_env * env);
+
+extern int tst_comm_cart_create_init (struct tst_env * env);
+extern int tst_comm_cart_create_run (struct tst_env * env);
+extern int tst_comm_cart_create_cleanup (struct tst_env * env);
+
 #endif /* __MPI_TESTSUITE_H__ */
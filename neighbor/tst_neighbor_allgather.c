@@ -0,0 +1,120 @@
+/*
+ * File: tst_neighbor_allgather.c
+ *
+ * Functionality:
+ *  Gathers the values of all neighbors with MPI_Neighbor_allgather, its
+ *  nonblocking form MPI_Ineighbor_allgather and, as of MPI-4, its persistent
+ *  form MPI_Neighbor_allgather_init. In benchmark mode the reference is the
+ *  equivalent halo exchange by MPI_Isend and MPI_Irecv.
+ *  Works with Cartesian, graph and distributed graph communicators and any C type.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_benchmark.h"
+#include "tst_neighbor.h"
+
+
+static int tst_neighbor_allgather_reference (struct tst_env * env)
+{
+  const MPI_Aint stride = (MPI_Aint) env->values_num * tst_type_gettypesize (env->type);
+
+  return tst_neighbor_exchange (env, env->send_buffer, 0, env->reference_buffer, stride);
+}
+
+
+int tst_neighbor_allgather_init (struct tst_env * env)
+{
+  int comm_rank;
+  int indegree;
+  int outdegree;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  comm = tst_comm_getcomm (env->comm);
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  tst_neighbor_init (env);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+
+  env->send_buffer = tst_type_allocvalues (env->type, env->values_num);
+  env->recv_buffer = tst_type_allocvalues (env->type, indegree * env->values_num);
+  env->reference_buffer = tst_type_allocvalues (env->type, indegree * env->values_num);
+  tst_type_setstandardarray (env->type, env->values_num, env->send_buffer, comm_rank);
+
+  tst_benchmark_setreference (env, &tst_neighbor_allgather_reference, "Isend/Irecv halo exchange");
+  return 0;
+}
+
+int tst_neighbor_allgather_run (struct tst_env * env)
+{
+  MPI_Datatype type;
+
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Neighbor_allgather (env->send_buffer, env->values_num, type,
+                                     env->recv_buffer, env->values_num, type,
+                                     tst_comm_getcomm (env->comm)));
+  return 0;
+}
+
+int tst_neighbor_iallgather_run (struct tst_env * env)
+{
+  MPI_Datatype type;
+
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Ineighbor_allgather (env->send_buffer, env->values_num, type,
+                                      env->recv_buffer, env->values_num, type,
+                                      tst_comm_getcomm (env->comm), &env->req_buffer[0]));
+  MPI_CHECK (MPI_Wait (&env->req_buffer[0], MPI_STATUS_IGNORE));
+  return 0;
+}
+
+int tst_neighbor_allgather_cleanup (struct tst_env * env)
+{
+  int indegree;
+  int outdegree;
+
+  /*
+   * Checked once after all iterations, keeping the check out of the timings.
+   */
+  tst_neighbor_checkgathered (env, env->recv_buffer, (MPI_Aint) env->values_num * tst_type_gettypesize (env->type));
+
+  tst_neighbor_count (tst_comm_getcomm (env->comm), &indegree, &outdegree);
+  tst_type_freevalues (env->type, env->send_buffer, env->values_num);
+  tst_type_freevalues (env->type, env->recv_buffer, indegree * env->values_num);
+  tst_type_freevalues (env->type, env->reference_buffer, indegree * env->values_num);
+  tst_neighbor_cleanup (env);
+  return 0;
+}
+
+
+#if MPI_VERSION >= 4
+int tst_neighbor_allgather_persistent_init (struct tst_env * env)
+{
+  MPI_Datatype type;
+
+  tst_neighbor_allgather_init (env);
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Neighbor_allgather_init (env->send_buffer, env->values_num, type,
+                                          env->recv_buffer, env->values_num, type,
+                                          tst_comm_getcomm (env->comm), MPI_INFO_NULL,
+                                          tst_neighbor_request (env)));
+  return 0;
+}
+
+int tst_neighbor_allgather_persistent_run (struct tst_env * env)
+{
+  MPI_Request * request = tst_neighbor_request (env);
+
+  MPI_CHECK (MPI_Start (request));
+  MPI_CHECK (MPI_Wait (request, MPI_STATUS_IGNORE));
+  return 0;
+}
+
+int tst_neighbor_allgather_persistent_cleanup (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Request_free (tst_neighbor_request (env)));
+  return tst_neighbor_allgather_cleanup (env);
+}
+#endif
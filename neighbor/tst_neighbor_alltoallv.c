@@ -0,0 +1,145 @@
+/*
+ * File: tst_neighbor_alltoallv.c
+ *
+ * Functionality:
+ *  Exchanges a separate block with every neighbor with MPI_Neighbor_alltoallv,
+ *  its nonblocking form MPI_Ineighbor_alltoallv and, as of MPI-4, its persistent
+ *  form MPI_Neighbor_alltoallv_init. The blocks are separated by a gap of one
+ *  value, to check the displacements. In benchmark mode the reference is the
+ *  equivalent halo exchange by MPI_Isend and MPI_Irecv.
+ *  Works with Cartesian, graph and distributed graph communicators and any C type.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_benchmark.h"
+#include "tst_neighbor.h"
+
+
+/*
+ * Bytes between the blocks of two neighbors.
+ */
+static MPI_Aint tst_neighbor_alltoallv_stride (const struct tst_env * env)
+{
+  return (MPI_Aint) (env->values_num + 1) * tst_type_gettypesize (env->type);
+}
+
+
+static int tst_neighbor_alltoallv_reference (struct tst_env * env)
+{
+  const MPI_Aint stride = tst_neighbor_alltoallv_stride (env);
+
+  return tst_neighbor_exchange (env, env->send_buffer, stride, env->reference_buffer, stride);
+}
+
+
+int tst_neighbor_alltoallv_init (struct tst_env * env)
+{
+  int indegree;
+  int outdegree;
+  int degree;
+  int i;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_neighbor_init (env);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+
+  env->send_buffer = tst_type_allocvalues (env->type, outdegree * (env->values_num + 1));
+  env->recv_buffer = tst_type_allocvalues (env->type, indegree * (env->values_num + 1));
+  env->reference_buffer = tst_type_allocvalues (env->type, indegree * (env->values_num + 1));
+  tst_neighbor_setblocks (env, env->send_buffer, tst_neighbor_alltoallv_stride (env));
+
+  /*
+   * The same counts and displacements serve for sending and receiving.
+   */
+  degree = (indegree > outdegree) ? indegree : outdegree;
+  if ((env->send_counts = malloc ((degree + 1) * sizeof (int))) == NULL ||
+      (env->send_displs = malloc ((degree + 1) * sizeof (int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < degree; i++)
+    {
+      env->send_counts[i] = env->values_num;
+      env->send_displs[i] = i * (env->values_num + 1);
+    }
+
+  tst_benchmark_setreference (env, &tst_neighbor_alltoallv_reference, "Isend/Irecv halo exchange");
+  return 0;
+}
+
+int tst_neighbor_alltoallv_run (struct tst_env * env)
+{
+  MPI_Datatype type;
+
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Neighbor_alltoallv (env->send_buffer, env->send_counts, env->send_displs, type,
+                                     env->recv_buffer, env->send_counts, env->send_displs, type,
+                                     tst_comm_getcomm (env->comm)));
+  return 0;
+}
+
+int tst_neighbor_ialltoallv_run (struct tst_env * env)
+{
+  MPI_Datatype type;
+
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Ineighbor_alltoallv (env->send_buffer, env->send_counts, env->send_displs, type,
+                                      env->recv_buffer, env->send_counts, env->send_displs, type,
+                                      tst_comm_getcomm (env->comm), &env->req_buffer[0]));
+  MPI_CHECK (MPI_Wait (&env->req_buffer[0], MPI_STATUS_IGNORE));
+  return 0;
+}
+
+int tst_neighbor_alltoallv_cleanup (struct tst_env * env)
+{
+  int indegree;
+  int outdegree;
+
+  /*
+   * Checked once after all iterations, keeping the check out of the timings.
+   */
+  tst_neighbor_checkblocks (env, env->recv_buffer, tst_neighbor_alltoallv_stride (env));
+
+  tst_neighbor_count (tst_comm_getcomm (env->comm), &indegree, &outdegree);
+  tst_type_freevalues (env->type, env->send_buffer, outdegree * (env->values_num + 1));
+  tst_type_freevalues (env->type, env->recv_buffer, indegree * (env->values_num + 1));
+  tst_type_freevalues (env->type, env->reference_buffer, indegree * (env->values_num + 1));
+  free (env->send_counts);
+  free (env->send_displs);
+  tst_neighbor_cleanup (env);
+  return 0;
+}
+
+
+#if MPI_VERSION >= 4
+int tst_neighbor_alltoallv_persistent_init (struct tst_env * env)
+{
+  MPI_Datatype type;
+
+  tst_neighbor_alltoallv_init (env);
+  type = tst_type_getdatatype (env->type);
+  MPI_CHECK (MPI_Neighbor_alltoallv_init (env->send_buffer, env->send_counts, env->send_displs, type,
+                                          env->recv_buffer, env->send_counts, env->send_displs, type,
+                                          tst_comm_getcomm (env->comm), MPI_INFO_NULL,
+                                          tst_neighbor_request (env)));
+  return 0;
+}
+
+int tst_neighbor_alltoallv_persistent_run (struct tst_env * env)
+{
+  MPI_Request * request = tst_neighbor_request (env);
+
+  MPI_CHECK (MPI_Start (request));
+  MPI_CHECK (MPI_Wait (request, MPI_STATUS_IGNORE));
+  return 0;
+}
+
+int tst_neighbor_alltoallv_persistent_cleanup (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Request_free (tst_neighbor_request (env)));
+  return tst_neighbor_alltoallv_cleanup (env);
+}
+#endif
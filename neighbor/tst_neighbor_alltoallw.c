@@ -0,0 +1,161 @@
+/*
+ * File: tst_neighbor_alltoallw.c
+ *
+ * Functionality:
+ *  Exchanges a separate block with every neighbor with MPI_Neighbor_alltoallw,
+ *  its nonblocking form MPI_Ineighbor_alltoallw and, as of MPI-4, its persistent
+ *  form MPI_Neighbor_alltoallw_init, giving a datatype and a displacement in
+ *  bytes per neighbor. The blocks are stored in reverse order of the neighbors,
+ *  separated by a gap of one value. In benchmark mode the reference is the
+ *  equivalent halo exchange by MPI_Isend and MPI_Irecv.
+ *  Works with Cartesian, graph and distributed graph communicators and any C type.
+ */
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_benchmark.h"
+#include "tst_neighbor.h"
+
+
+/*
+ * Bytes between the blocks of two neighbors.
+ */
+static MPI_Aint tst_neighbor_alltoallw_stride (const struct tst_env * env)
+{
+  return (MPI_Aint) (env->values_num + 1) * tst_type_gettypesize (env->type);
+}
+
+
+/*
+ * The block of the first neighbor comes last, the blocks are then given by a negative stride.
+ */
+static char * tst_neighbor_alltoallw_first (const struct tst_env * env, char * buffer, int degree)
+{
+  return buffer + (degree > 0 ? degree - 1 : 0) * tst_neighbor_alltoallw_stride (env);
+}
+
+
+static int tst_neighbor_alltoallw_reference (struct tst_env * env)
+{
+  const MPI_Aint stride = tst_neighbor_alltoallw_stride (env);
+  int indegree;
+  int outdegree;
+
+  tst_neighbor_count (tst_comm_getcomm (env->comm), &indegree, &outdegree);
+  return tst_neighbor_exchange (env, tst_neighbor_alltoallw_first (env, env->send_buffer, outdegree), -stride,
+                                tst_neighbor_alltoallw_first (env, env->reference_buffer, indegree), -stride);
+}
+
+
+int tst_neighbor_alltoallw_init (struct tst_env * env)
+{
+  const MPI_Aint stride = tst_neighbor_alltoallw_stride (env);
+  int indegree;
+  int outdegree;
+  int degree;
+  int i;
+  MPI_Comm comm;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d env->type:%d env->values_num:%d\n",
+                 tst_global_rank, env->comm, env->type, env->values_num);
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_neighbor_init (env);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+
+  env->send_buffer = tst_type_allocvalues (env->type, outdegree * (env->values_num + 1));
+  env->recv_buffer = tst_type_allocvalues (env->type, indegree * (env->values_num + 1));
+  env->reference_buffer = tst_type_allocvalues (env->type, indegree * (env->values_num + 1));
+  tst_neighbor_setblocks (env, tst_neighbor_alltoallw_first (env, env->send_buffer, outdegree), -stride);
+
+  degree = (indegree > outdegree) ? indegree : outdegree;
+  if ((env->send_counts = malloc ((degree + 1) * sizeof (int))) == NULL ||
+      (env->send_byte_displs = malloc ((degree + 1) * sizeof (MPI_Aint))) == NULL ||
+      (env->recv_byte_displs = malloc ((degree + 1) * sizeof (MPI_Aint))) == NULL ||
+      (env->send_types = malloc ((degree + 1) * sizeof (MPI_Datatype))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < degree; i++)
+    {
+      env->send_counts[i] = env->values_num;
+      env->send_byte_displs[i] = (outdegree - 1 - i) * stride;
+      env->recv_byte_displs[i] = (indegree - 1 - i) * stride;
+      env->send_types[i] = tst_type_getdatatype (env->type);
+    }
+
+  tst_benchmark_setreference (env, &tst_neighbor_alltoallw_reference, "Isend/Irecv halo exchange");
+  return 0;
+}
+
+int tst_neighbor_alltoallw_run (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Neighbor_alltoallw (env->send_buffer, env->send_counts,
+                                     env->send_byte_displs, env->send_types,
+                                     env->recv_buffer, env->send_counts,
+                                     env->recv_byte_displs, env->send_types,
+                                     tst_comm_getcomm (env->comm)));
+  return 0;
+}
+
+int tst_neighbor_ialltoallw_run (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Ineighbor_alltoallw (env->send_buffer, env->send_counts,
+                                      env->send_byte_displs, env->send_types,
+                                      env->recv_buffer, env->send_counts,
+                                      env->recv_byte_displs, env->send_types,
+                                      tst_comm_getcomm (env->comm), &env->req_buffer[0]));
+  MPI_CHECK (MPI_Wait (&env->req_buffer[0], MPI_STATUS_IGNORE));
+  return 0;
+}
+
+int tst_neighbor_alltoallw_cleanup (struct tst_env * env)
+{
+  int indegree;
+  int outdegree;
+
+  /*
+   * Checked once after all iterations, keeping the check out of the timings.
+   */
+  tst_neighbor_count (tst_comm_getcomm (env->comm), &indegree, &outdegree);
+  tst_neighbor_checkblocks (env, tst_neighbor_alltoallw_first (env, env->recv_buffer, indegree),
+                            -tst_neighbor_alltoallw_stride (env));
+
+  tst_type_freevalues (env->type, env->send_buffer, outdegree * (env->values_num + 1));
+  tst_type_freevalues (env->type, env->recv_buffer, indegree * (env->values_num + 1));
+  tst_type_freevalues (env->type, env->reference_buffer, indegree * (env->values_num + 1));
+  free (env->send_counts);
+  free (env->send_byte_displs);
+  free (env->recv_byte_displs);
+  free (env->send_types);
+  tst_neighbor_cleanup (env);
+  return 0;
+}
+
+
+#if MPI_VERSION >= 4
+int tst_neighbor_alltoallw_persistent_init (struct tst_env * env)
+{
+  tst_neighbor_alltoallw_init (env);
+  MPI_CHECK (MPI_Neighbor_alltoallw_init (env->send_buffer, env->send_counts,
+                                          env->send_byte_displs, env->send_types,
+                                          env->recv_buffer, env->send_counts,
+                                          env->recv_byte_displs, env->send_types,
+                                          tst_comm_getcomm (env->comm), MPI_INFO_NULL,
+                                          tst_neighbor_request (env)));
+  return 0;
+}
+
+int tst_neighbor_alltoallw_persistent_run (struct tst_env * env)
+{
+  MPI_Request * request = tst_neighbor_request (env);
+
+  MPI_CHECK (MPI_Start (request));
+  MPI_CHECK (MPI_Wait (request, MPI_STATUS_IGNORE));
+  return 0;
+}
+
+int tst_neighbor_alltoallw_persistent_cleanup (struct tst_env * env)
+{
+  MPI_CHECK (MPI_Request_free (tst_neighbor_request (env)));
+  return tst_neighbor_alltoallw_cleanup (env);
+}
+#endif
@@ -20,7 +20,7 @@ static char * recv_buffer = NULL;
 */
 
 /* XXX the following could maybe put into the env */
-static MPI_Aint send_buffer_size = 0;
+static tst_count send_buffer_size = 0;
 static MPI_Win send_win = MPI_WIN_NULL;
 
 int tst_one_sided_simple_ring_get_init (struct tst_env * env)
@@ -47,7 +47,7 @@ int tst_one_sided_simple_ring_get_init (struct tst_env * env)
    */
   tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Going to create window\n",
                  tst_global_rank);
-  MPI_Win_create (env->send_buffer, send_buffer_size, type_size,
+  MPI_Win_create (env->send_buffer, (MPI_Aint) send_buffer_size, type_size,
                   MPI_INFO_NULL, comm, &send_win);
 
   return 0;
@@ -15,7 +15,7 @@
 #ifdef HAVE_MPI2_ONE_SIDED
 
 /* XXX CN could maybe placed into env */
-static MPI_Aint send_buffer_size = 0;
+static tst_count send_buffer_size = 0;
 static MPI_Win send_win = MPI_WIN_NULL;
 static MPI_Group group_from = MPI_GROUP_NULL;
 static MPI_Group group_to = MPI_GROUP_NULL;
@@ -67,7 +67,7 @@ int tst_one_sided_simple_ring_get_post_init (struct tst_env * env)
   /*
    * Create a window for the send and the receive buffer
    */
-  MPI_CHECK (MPI_Win_create (env->send_buffer, send_buffer_size, type_size,
+  MPI_CHECK (MPI_Win_create (env->send_buffer, (MPI_Aint) send_buffer_size, type_size,
                              MPI_INFO_NULL, comm, &send_win));
 
   MPI_CHECK (MPI_Group_free (&comm_group));
@@ -15,7 +15,7 @@
 #ifdef HAVE_MPI2_ONE_SIDED
 
 /* XXX CN Could maybe placed into env */
-static MPI_Aint recv_buffer_size = 0;
+static tst_count recv_buffer_size = 0;
 static MPI_Win recv_win = MPI_WIN_NULL;
 
 int tst_one_sided_simple_ring_put_init (struct tst_env * env)
@@ -42,7 +42,7 @@ int tst_one_sided_simple_ring_put_init (struct tst_env * env)
    */
   tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Going to create window\n",
                  tst_global_rank);
-  MPI_Win_create (env->recv_buffer, recv_buffer_size, type_size,
+  MPI_Win_create (env->recv_buffer, (MPI_Aint) recv_buffer_size, type_size,
                   MPI_INFO_NULL, comm, &recv_win);
 
   return 0;
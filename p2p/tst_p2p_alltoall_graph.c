@@ -16,6 +16,45 @@
 #include "tst_output.h"
 
 
+/*
+ * Get the number of neighbors and, unless NULL, the neighbors of a graph communicator,
+ * respectively the sources of a distributed graph communicator, whose graphs are symmetric.
+ */
+static int tst_p2p_alltoall_graph_neighbors (MPI_Comm comm, int * neighbors)
+{
+  int comm_rank;
+  int neighbors_num;
+  int topology;
+
+  MPI_CHECK (MPI_Topo_test (comm, &topology));
+#if MPI_VERSION >= 3
+  if (topology == MPI_DIST_GRAPH)
+    {
+      int outdegree;
+      int weighted;
+      MPI_CHECK (MPI_Dist_graph_neighbors_count (comm, &neighbors_num, &outdegree, &weighted));
+      if (neighbors != NULL)
+        {
+          int * destinations;
+          int * weights;
+          if ((destinations = malloc (sizeof (int) * (outdegree + 1))) == NULL ||
+              (weights = malloc (sizeof (int) * (neighbors_num + outdegree + 1))) == NULL)
+            ERROR (errno, "malloc");
+          MPI_CHECK (MPI_Dist_graph_neighbors (comm, neighbors_num, neighbors, weights,
+                                               outdegree, destinations, weights + neighbors_num));
+          free (destinations);
+          free (weights);
+        }
+      return neighbors_num;
+    }
+#endif
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  MPI_CHECK (MPI_Graph_neighbors_count (comm, comm_rank, &neighbors_num));
+  if (neighbors != NULL)
+    MPI_CHECK (MPI_Graph_neighbors (comm, comm_rank, neighbors_num, neighbors));
+  return neighbors_num;
+}
+
 
 int tst_p2p_alltoall_graph_init (struct tst_env * env)
 {
@@ -32,7 +71,7 @@ int tst_p2p_alltoall_graph_init (struct tst_env * env)
    */
   comm = tst_comm_getcomm (env->comm);
   MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
-  MPI_CHECK (MPI_Graph_neighbors_count (comm, comm_rank, &neighbors_num));
+  neighbors_num = tst_p2p_alltoall_graph_neighbors (comm, NULL);
   env->send_buffer = tst_type_allocvalues (env->type, env->values_num);
   tst_type_setstandardarray (env->type, env->values_num,
                              env->send_buffer, comm_rank);
@@ -68,8 +107,7 @@ int tst_p2p_alltoall_graph_run (struct tst_env * env)
   type = tst_type_getdatatype (env->type);
   MPI_CHECK (MPI_Comm_rank(comm, &comm_rank));
   MPI_CHECK (MPI_Comm_size(comm, &comm_size));
-  MPI_CHECK (MPI_Graph_neighbors_count (comm, comm_rank, &neighbors_num));
-  MPI_CHECK (MPI_Graph_neighbors(comm, comm_rank, neighbors_num, env->neighbors));
+  neighbors_num = tst_p2p_alltoall_graph_neighbors (comm, env->neighbors);
   tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) comm_size:%d comm_rank:%d\n",
                  tst_global_rank, comm_size, comm_rank);
 
@@ -112,11 +150,9 @@ int tst_p2p_alltoall_graph_cleanup (struct tst_env * env)
   MPI_Comm comm;
   int i;
   int neighbors_num;
-  int comm_rank;
   comm = tst_comm_getcomm (env->comm);
   tst_type_freevalues (env->type, env->send_buffer, env->values_num);
-  MPI_CHECK (MPI_Comm_rank(comm, &comm_rank));
-  MPI_CHECK (MPI_Graph_neighbors_count (comm, comm_rank, &neighbors_num));
+  neighbors_num = tst_p2p_alltoall_graph_neighbors (comm, NULL);
   for (i = 0; i < neighbors_num; i++)
       tst_type_freevalues (env->type, env->recv_buffer_array[i], env->values_num);
 
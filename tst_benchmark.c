@@ -0,0 +1,294 @@
+#include "config.h"
+
+#include "tst_benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_comm.h"
+#include "tst_output.h"
+#include "tst_pool.h"
+
+
+/*
+ * Enough for sweeping communicators of up to INT_MAX processes in powers of two.
+ */
+#define TST_BENCHMARK_SWEEP_MAX 33
+
+
+static int tst_benchmark_iterations = 0;
+static int tst_benchmark_warmup = 0;
+static double * tst_benchmark_times = NULL;       /* Times of the timed iterations on this rank */
+static double * tst_benchmark_times_max = NULL;   /* Maximum over all ranks of the times above */
+static tst_benchmark_run_func tst_benchmark_reference = NULL;
+static const struct tst_env * tst_benchmark_reference_env = NULL;   /* Environment of the test which set the reference */
+static const char * tst_benchmark_reference_description = NULL;
+static double tst_benchmark_median_last = 0.0;    /* Median of the test timed last, on rank 0 of its communicator if aggregated */
+
+
+static int tst_benchmark_cmp_double (const void * a, const void * b)
+{
+  const double da = *(const double *) a;
+  const double db = *(const double *) b;
+  return (da > db) - (da < db);
+}
+
+
+int tst_benchmark_init (int iterations, int warmup)
+{
+  if (iterations < 0 || warmup < 0)
+    ERROR (EINVAL, "Number of benchmark iterations must not be negative");
+
+  tst_benchmark_iterations = iterations;
+  tst_benchmark_warmup = warmup;
+  if (0 == iterations)
+    return 0;
+
+  if ((tst_benchmark_times = malloc (iterations * sizeof (double))) == NULL)
+    ERROR (errno, "malloc");
+  if ((tst_benchmark_times_max = malloc (iterations * sizeof (double))) == NULL)
+    ERROR (errno, "malloc");
+  return 0;
+}
+
+
+int tst_benchmark_cleanup (void)
+{
+  free (tst_benchmark_times);
+  free (tst_benchmark_times_max);
+  tst_benchmark_times = NULL;
+  tst_benchmark_times_max = NULL;
+  tst_benchmark_iterations = 0;
+  return 0;
+}
+
+
+int tst_benchmark_enabled (void)
+{
+  return tst_benchmark_iterations > 0;
+}
+
+
+/*
+ * Reduces the times of all ranks of comm to the maximum on its rank 0,
+ * returns whether the calling rank got them.
+ */
+static int tst_benchmark_reduce (MPI_Comm comm, int n)
+{
+  MPI_Comm intra_comm;
+  int is_inter;
+  int comm_rank;
+
+  /*
+   * Both groups of an inter-communicator are reduced together, the merge is not timed.
+   */
+  MPI_CHECK (MPI_Comm_test_inter (comm, &is_inter));
+  if (is_inter)
+    MPI_CHECK (MPI_Intercomm_merge (comm, 0, &intra_comm));
+  else
+    intra_comm = comm;
+
+  MPI_CHECK (MPI_Reduce (tst_benchmark_times, tst_benchmark_times_max, n,
+                         MPI_DOUBLE, MPI_MAX, 0, intra_comm));
+  MPI_CHECK (MPI_Comm_rank (intra_comm, &comm_rank));
+  if (is_inter)
+    MPI_CHECK (MPI_Comm_free (&intra_comm));
+  return comm_rank == 0;
+}
+
+
+/*
+ * Runs the warmup and timed iterations of run_func, returns the sorted times,
+ * or NULL on the ranks other than 0 of the communicator, if the times are aggregated.
+ */
+static double * tst_benchmark_time (struct tst_env * env, tst_benchmark_run_func run_func, int aggregate)
+{
+  const int n = tst_benchmark_iterations;
+  const MPI_Comm comm = tst_comm_getmastercomm (env->comm);
+  double * times;
+  int i;
+
+  for (i = 0; i < tst_benchmark_warmup; i++)
+    {
+      if (aggregate)
+        MPI_CHECK (MPI_Barrier (comm));
+      run_func (env);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      double time_start;
+      if (aggregate)
+        MPI_CHECK (MPI_Barrier (comm));
+      time_start = MPI_Wtime ();
+      run_func (env);
+      tst_benchmark_times[i] = MPI_Wtime () - time_start;
+    }
+
+  /*
+   * An iteration takes as long as its slowest rank.
+   */
+  if (aggregate)
+    {
+      if (!tst_benchmark_reduce (comm, n))
+        return NULL;
+      times = tst_benchmark_times_max;
+    }
+  else
+    times = tst_benchmark_times;
+
+  qsort (times, n, sizeof (double), tst_benchmark_cmp_double);
+  return times;
+}
+
+
+static double tst_benchmark_median (const double * times, int n)
+{
+  return (n % 2) ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]);
+}
+
+
+int tst_benchmark_setreference (const struct tst_env * env, tst_benchmark_run_func ref_func, const char * description)
+{
+  if (!tst_benchmark_enabled ())
+    return 0;
+  tst_benchmark_reference = ref_func;
+  tst_benchmark_reference_env = env;
+  tst_benchmark_reference_description = description;
+  return 0;
+}
+
+
+int tst_benchmark_run (struct tst_env * env, tst_benchmark_run_func run_func, int aggregate)
+{
+  const int n = tst_benchmark_iterations;
+  tst_benchmark_run_func ref_func;
+  double * times;
+  double median;
+  double ref_median;
+  double bytes;
+  int p99;
+
+  /*
+   * The reference only applies to the test which set it, not e.g. to one being bisected.
+   */
+  ref_func = (tst_benchmark_reference_env == env) ? tst_benchmark_reference : NULL;
+  tst_benchmark_reference = NULL;
+  tst_benchmark_reference_env = NULL;
+
+  /*
+   * Ranks without the communicator are not part of the test, e.g. when run concurrently.
+   */
+  tst_benchmark_median_last = 0.0;
+  if (tst_comm_getmastercomm (env->comm) == MPI_COMM_NULL)
+    return 0;
+
+  times = tst_benchmark_time (env, run_func, aggregate);
+  bytes = (double) env->values_count * tst_type_gettypesize (env->type);
+  median = (times != NULL) ? tst_benchmark_median (times, n) : 0.0;
+  tst_benchmark_median_last = median;
+
+  if (times != NULL && tst_report >= TST_REPORT_SUMMARY)
+    {
+      p99 = (99 * n + 99) / 100 - 1;
+      if (!aggregate)
+        printf ("(Rank:%d) ", tst_global_rank);
+      printf ("Benchmark test %s, comm %s, type %s, num values %lld (%.0f bytes), placement %s, buffer offset %d, iterations %d: "
+              "min %.2f us, median %.2f us, p99 %.2f us, max %.2f us, bandwidth %.2f MB/s\n",
+              tst_test_getdescription (env->test),
+              tst_comm_getdescription (env->comm),
+              tst_type_getdescription (env->type),
+              (long long) env->values_count, bytes, tst_pool_getplacement (), env->buffer_offset, n,
+              1e6 * times[0], 1e6 * median, 1e6 * times[p99], 1e6 * times[n - 1],
+              median > 0.0 ? bytes / median / 1e6 : 0.0);
+    }
+
+  if (ref_func == NULL)
+    return 0;
+
+  times = tst_benchmark_time (env, ref_func, aggregate);
+  if (times != NULL && tst_report >= TST_REPORT_SUMMARY)
+    {
+      ref_median = tst_benchmark_median (times, n);
+      if (!aggregate)
+        printf ("(Rank:%d) ", tst_global_rank);
+      printf ("Benchmark reference %s of test %s, type %s: median %.2f us, %.3f GB/s versus %.3f GB/s, "
+              "overhead ratio %.2f\n",
+              tst_benchmark_reference_description,
+              tst_test_getdescription (env->test),
+              tst_type_getdescription (env->type),
+              1e6 * ref_median,
+              ref_median > 0.0 ? bytes / ref_median / 1e9 : 0.0,
+              median > 0.0 ? bytes / median / 1e9 : 0.0,
+              ref_median > 0.0 ? median / ref_median : 0.0);
+    }
+  return 0;
+}
+
+
+/*
+ * Runs all phases of the test on env_sweep with the communicator comm,
+ * appending the median to the curve if the test is applicable.
+ */
+static int tst_benchmark_sweep_point (struct tst_env * env_sweep, int comm, int size,
+                                      int * sizes, double * medians, int * num)
+{
+  env_sweep->comm = comm;
+  if (!tst_test_check_run (env_sweep))
+    return 0;
+
+  tst_test_init_func (env_sweep);
+  tst_benchmark_run (env_sweep, &tst_test_run_func, tst_test_check_aggregate (env_sweep));
+  tst_test_cleanup_func (env_sweep);
+  sizes[*num] = size;
+  medians[*num] = tst_benchmark_median_last;
+  (*num)++;
+  return 0;
+}
+
+
+int tst_benchmark_sweep (struct tst_env * env)
+{
+  struct tst_env env_sweep;
+  int sizes[TST_BENCHMARK_SWEEP_MAX];
+  double medians[TST_BENCHMARK_SWEEP_MAX];
+  int num = 0;
+  int min_size;
+  int size;
+  int scratch;
+  int comm_rank = -1;
+  int i;
+
+  /*
+   * The sizes have to agree on all ranks, the communicator itself concludes the sweep.
+   */
+  min_size = tst_comm_getminsize (env->comm);
+  for (size = 1; size < min_size; size *= 2)
+    {
+      env_sweep = *env;
+      scratch = tst_comm_register_scratch (env->comm, size);
+      tst_benchmark_sweep_point (&env_sweep, scratch, size, sizes, medians, &num);
+      tst_comm_free_scratch (scratch);
+    }
+  env_sweep = *env;
+  tst_benchmark_sweep_point (&env_sweep, env->comm, min_size, sizes, medians, &num);
+
+  /*
+   * The first processes of the communicator include its rank 0, which got all medians.
+   */
+  if (tst_comm_getmastercomm (env->comm) != MPI_COMM_NULL)
+    MPI_CHECK (MPI_Comm_rank (tst_comm_getmastercomm (env->comm), &comm_rank));
+  if (comm_rank == 0 && tst_report >= TST_REPORT_SUMMARY && num > 0)
+    {
+      printf ("Benchmark scaling of test %s, comm %s, median per number of processes:",
+              tst_test_getdescription (env->test),
+              tst_comm_getdescription (env->comm));
+      for (i = 0; i < num; i++)
+        printf ("%s %d: %.2f us", i ? "," : "", sizes[i], 1e6 * medians[i]);
+      printf ("\n");
+    }
+  return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef TST_BENCHMARK_H_
+#define TST_BENCHMARK_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Signature of the function executing the run phase of a test */
+typedef int (*tst_benchmark_run_func) (struct tst_env * env);
+
+/** \brief Enable benchmark mode
+ *
+ * \param[in] iterations  number of timed iterations of the run phase, 0 disables benchmark mode
+ * \param[in] warmup      number of untimed iterations preceding the timed ones
+ *
+ * \return 0 on success
+ */
+int tst_benchmark_init (int iterations, int warmup);
+
+/** \brief Release all resources of the benchmark mode */
+int tst_benchmark_cleanup (void);
+
+/** \brief Check whether benchmark mode is enabled
+ *
+ * \return 1 if benchmark mode is enabled, 0 otherwise
+ */
+int tst_benchmark_enabled (void);
+
+/** \brief Set a reference implementation the next benchmarked test is compared against
+ *
+ * To be called by the init phase of a test; no-op unless benchmark mode is
+ * enabled. After timing the run phase, tst_benchmark_run times ref_func
+ * the same way and reports its bandwidth and the ratio of the medians.
+ *
+ * \param[in] env          environment of the test
+ * \param[in] ref_func     function executing the reference, e.g. a hand-written copy loop
+ * \param[in] description  short description of the reference
+ *
+ * \return 0 on success
+ */
+int tst_benchmark_setreference (const struct tst_env * env, tst_benchmark_run_func ref_func, const char * description);
+
+/** \brief Execute the run phase of a test repeatedly and report timing statistics
+ *
+ * Runs the warmup iterations followed by the timed iterations of run_func.
+ * If aggregate is set, every iteration is preceded by a barrier on the
+ * communicator of the test and the per-iteration times are reduced to the
+ * maximum over its ranks, which therefore all have to call this function for
+ * the same test; rank 0 of the communicator reports them. Otherwise the
+ * statistics of the calling rank are reported. Ranks without the
+ * communicator return right away.
+ *
+ * \param[in,out] env        environment of the test to be run
+ * \param[in]     run_func   function executing the run phase
+ * \param[in]     aggregate  non-zero to aggregate the times over the ranks of the communicator
+ *
+ * \return 0 on success
+ */
+int tst_benchmark_run (struct tst_env * env, tst_benchmark_run_func run_func, int aggregate);
+
+/** \brief Benchmark all phases of a test with a growing number of processes
+ *
+ * Runs the test with tst_benchmark_run on the first 1, 2, 4, ... processes
+ * of its intra-communicator and finally on the communicator itself, then
+ * reports the medians of all sizes as scaling curve on rank 0 of the
+ * communicator. Collective over MPI_COMM_WORLD, replaces the init, run and
+ * cleanup phase of the test.
+ *
+ * \param[in,out] env  environment of the test to be run
+ *
+ * \return 0 on success
+ */
+int tst_benchmark_sweep (struct tst_env * env);
+
+#endif  /* TST_BENCHMARK_H_ */
@@ -0,0 +1,139 @@
+#include "config.h"
+
+#include "tst_bisect.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_comm.h"
+#include "tst_output.h"
+#include "tst_threads.h"
+#include "tst_watchdog.h"
+
+
+/*
+ * Returns whether the rerun failed on any rank.
+ */
+static int tst_bisect_check (int failed)
+{
+  int failed_any;
+
+  MPI_CHECK (MPI_Allreduce (&failed, &failed_any, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD));
+  return failed_any;
+}
+
+
+/*
+ * Rerun the test on comm with values_count values, the same way as the main loop
+ * and guarded by the watchdog; returns whether it failed on any rank.
+ */
+static int tst_bisect_trial (const struct tst_env * env_failed, struct tst_thread_env_t ** thread_env,
+                             int comm, tst_count values_count)
+{
+  struct tst_env env;
+  int events;
+
+  memset (&env, 0, sizeof (env));
+  env.test       = env_failed->test;
+  env.type       = env_failed->type;
+  env.tag        = env_failed->tag;
+  env.comm       = comm;
+  env.buffer_offset = env_failed->buffer_offset;
+  env.values_num = (values_count > INT_MAX) ? INT_MAX : (int) values_count;
+  env.values_count = values_count;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "(Rank:%d) Bisecting test:%d comm:%d values_count:%lld\n",
+                     tst_global_rank, env.test, env.comm, (long long) env.values_count);
+
+  events = tst_test_get_failure_events ();
+  MPI_Barrier (MPI_COMM_WORLD);
+  tst_watchdog_start (&env);
+#ifdef HAVE_MPI2_THREADS
+  if (thread_env != NULL)
+    {
+      tst_thread_assign_all (&env, thread_env);
+      tst_thread_execute_init (&env);
+      tst_thread_execute_run (&env);
+      tst_thread_execute_cleanup (&env);
+    }
+  else
+#endif
+  if (tst_test_check_run (&env))
+    {
+      tst_test_init_func (&env);
+      tst_test_run_func (&env);
+      tst_test_cleanup_func (&env);
+    }
+  tst_watchdog_stop ();
+  MPI_Barrier (MPI_COMM_WORLD);
+  return tst_bisect_check (tst_test_get_failure_events () != events);
+}
+
+
+int tst_bisect (const struct tst_env * env, struct tst_thread_env_t ** thread_env)
+{
+  tst_count lo, hi, mid;
+  tst_count values_count;
+  int size;
+  int comm_size;
+  int scratch;
+
+  tst_test_suppress_failures (1);
+
+  /*
+   * Minimal number of values, assuming the test fails with any larger number.
+   */
+  lo = 1;
+  hi = env->values_count;
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (tst_bisect_trial (env, thread_env, env->comm, mid))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+  values_count = hi;
+
+  /*
+   * Minimal number of processes of the first processes of the communicator,
+   * the communicators of a split may differ in size on the ranks.
+   */
+  comm_size = tst_comm_getcommsize (env->comm);
+  MPI_CHECK (MPI_Allreduce (&comm_size, &size, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD));
+  comm_size = size;
+  if (tst_comm_getcommclass (env->comm) == TST_MPI_INTRA_COMM)
+    {
+      lo = 1;
+      hi = size;
+      while (lo < hi)
+        {
+          int failed;
+
+          mid = lo + (hi - lo) / 2;
+          scratch = tst_comm_register_scratch (env->comm, (int) mid);
+          failed = tst_bisect_trial (env, thread_env, scratch, values_count);
+          tst_comm_free_scratch (scratch);
+          if (failed)
+            hi = mid;
+          else
+            lo = mid + 1;
+        }
+      size = (int) hi;
+    }
+
+  tst_test_suppress_failures (0);
+
+  if (tst_global_rank == 0 && tst_report >= TST_REPORT_SUMMARY)
+    printf ("Bisection of failed %s test %s, comm %s, type %s: fails with %lld of %lld values on %d of %d processes\n",
+            tst_test_getclass_string (env->test),
+            tst_test_getdescription (env->test),
+            tst_comm_getdescription (env->comm),
+            tst_type_getdescription (env->type),
+            (long long) values_count, (long long) env->values_count, size, comm_size);
+  return 0;
+}
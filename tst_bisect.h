@@ -0,0 +1,23 @@
+#ifndef TST_BISECT_H_
+#define TST_BISECT_H_
+
+#include "mpi_test_suite.h"
+
+struct tst_thread_env_t;
+
+/** \brief Localize the failure of a test by bisection
+ *
+ * Reruns the failed test, binary searching for the minimal number of values
+ * and afterwards, for intra-communicators, the minimal number of processes
+ * it still fails with. The failures of the reruns are not recorded, every
+ * rerun is guarded by the watchdog.
+ * Has to be called by all ranks; rank 0 reports the result.
+ *
+ * \param[in] env         environment of the failed test
+ * \param[in] thread_env  environments of the worker threads to rerun the test with, or NULL
+ *
+ * \return 0 on success
+ */
+int tst_bisect (const struct tst_env * env, struct tst_thread_env_t ** thread_env);
+
+#endif  /* TST_BISECT_H_ */
@@ -0,0 +1,188 @@
+#include "config.h"
+
+#include "tst_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_plan.h"
+#include "tst_journal.h"
+
+
+#define TST_CACHE_LINE_MAX 1024
+
+struct tst_cache_entry {
+  char * key;     /* Tab-separated names of the test */
+  int seq;        /* Line number, later results supersede earlier ones */
+  int passed;     /* Whether the test passed */
+};
+
+static FILE * tst_cache = NULL;
+static char tst_cache_fingerprint[17];
+
+
+/*
+ * 64-bit FNV-1a hash of the fingerprint.
+ */
+static void tst_cache_hash (const char * str, char * hash)
+{
+  unsigned long long h = 14695981039346656037ULL;
+
+  for (; *str != '\0'; str++)
+    {
+      h ^= (unsigned char) *str;
+      h *= 1099511628211ULL;
+    }
+  sprintf (hash, "%016llx", h);
+}
+
+
+static int tst_cache_cmp_entry (const void * a, const void * b)
+{
+  const struct tst_cache_entry * ea = a;
+  const struct tst_cache_entry * eb = b;
+  int ret = strcmp (ea->key, eb->key);
+  return ret ? ret : (ea->seq > eb->seq) - (ea->seq < eb->seq);
+}
+
+
+/*
+ * Read the entries of the cache with the current fingerprint,
+ * sorted by key and, for the same key, by age.
+ */
+static int tst_cache_read (const char * filename, struct tst_cache_entry ** entries)
+{
+  char line[TST_CACHE_LINE_MAX];
+  char * key;
+  char * result;
+  FILE * file;
+  int entries_num = 0;
+  int entries_max = 0;
+  int seq;
+
+  *entries = NULL;
+  if ((file = fopen (filename, "r")) == NULL)
+    return 0;
+
+  for (seq = 0; fgets (line, sizeof (line), file) != NULL; seq++)
+    {
+      line[strcspn (line, "\n")] = '\0';
+      if ((key = strchr (line, '\t')) == NULL || (result = strrchr (line, '\t')) == key)
+        continue;
+      *key++ = '\0';
+      *result++ = '\0';
+      if (strcmp (line, tst_cache_fingerprint))
+        continue;
+
+      if (entries_num == entries_max)
+        {
+          entries_max = (entries_max == 0) ? 1024 : 2 * entries_max;
+          *entries = realloc (*entries, entries_max * sizeof (struct tst_cache_entry));
+          if (*entries == NULL)
+            ERROR (errno, "realloc");
+        }
+      if (((*entries)[entries_num].key = strdup (key)) == NULL)
+        ERROR (errno, "strdup");
+      (*entries)[entries_num].seq = seq;
+      (*entries)[entries_num].passed = !strcmp (result, "passed");
+      entries_num++;
+    }
+  fclose (file);
+
+  qsort (*entries, entries_num, sizeof (struct tst_cache_entry), tst_cache_cmp_entry);
+  return entries_num;
+}
+
+
+int tst_cache_init (const char * filename, const char * fingerprint, int force)
+{
+  struct tst_cache_entry * entries = NULL;
+  struct tst_env env;
+  char key[TST_CACHE_LINE_MAX];
+  int entries_num;
+  int num_plan;
+  int * keep;
+  int i;
+
+  tst_cache_hash (fingerprint, tst_cache_fingerprint);
+
+  num_plan = tst_plan_getnum ();
+  if ((keep = malloc ((num_plan + 1) * sizeof (int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < num_plan; i++)
+    keep[i] = 1;
+
+  if (tst_global_rank == 0 && !force)
+    {
+      int lo, hi, mid;
+
+      entries_num = tst_cache_read (filename, &entries);
+      for (i = 0; i < num_plan && entries_num > 0; i++)
+        {
+          tst_plan_getenv (i, &env);
+          tst_journal_getkey (&env, key, sizeof (key));
+
+          /*
+           * Find the last entry of the key.
+           */
+          lo = 0;
+          hi = entries_num;
+          while (lo < hi)
+            {
+              mid = (lo + hi) / 2;
+              if (strcmp (entries[mid].key, key) <= 0)
+                lo = mid + 1;
+              else
+                hi = mid;
+            }
+          if (lo > 0 && !strcmp (entries[lo - 1].key, key) && entries[lo - 1].passed)
+            keep[i] = 0;
+        }
+
+      for (i = 0; i < entries_num; i++)
+        free (entries[i].key);
+      free (entries);
+    }
+
+  MPI_CHECK (MPI_Bcast (keep, num_plan, MPI_INT, 0, MPI_COMM_WORLD));
+  i = num_plan - tst_plan_filter (keep);
+  free (keep);
+
+  if (tst_global_rank == 0)
+    {
+      if ((tst_cache = fopen (filename, "a")) == NULL)
+        ERROR (errno, "Could not open cache");
+      if (tst_report >= TST_REPORT_RUN)
+        printf ("Result cache %s (fingerprint %s: %s), skipping %d passed tests\n",
+                filename, tst_cache_fingerprint, fingerprint, i);
+    }
+  return i;
+}
+
+
+int tst_cache_cleanup (void)
+{
+  if (tst_cache != NULL)
+    fclose (tst_cache);
+  tst_cache = NULL;
+  return 0;
+}
+
+
+int tst_cache_record (const struct tst_env * env, int failed)
+{
+  char key[TST_CACHE_LINE_MAX];
+
+  if (tst_cache == NULL)
+    return 0;
+
+  tst_journal_getkey (env, key, sizeof (key));
+  fprintf (tst_cache, "%s\t%s\t%s\n", tst_cache_fingerprint, key, failed ? "failed" : "passed");
+  fflush (tst_cache);
+  return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef TST_CACHE_H_
+#define TST_CACHE_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Open the result cache and remove the tests passed before from the plan
+ *
+ * The cache holds the results of previous runs, keyed by a hash of
+ * the fingerprint of the MPI library, compiler, number of processes and
+ * settings of the run, and by the names of the test. Tests whose last
+ * result with the same fingerprint passed are removed from the plan,
+ * unless force is set.
+ * Has to be called by all ranks.
+ *
+ * \param[in] filename     name of the cache
+ * \param[in] fingerprint  description of the MPI library, compiler, number of processes and settings
+ * \param[in] force        non-zero to run all tests regardless of the cache
+ *
+ * \return number of entries removed from the plan
+ */
+int tst_cache_init (const char * filename, const char * fingerprint, int force);
+
+/** \brief Close the result cache */
+int tst_cache_cleanup (void);
+
+/** \brief Store the result of a finished test in the cache
+ *
+ * Only rank 0 writes the cache.
+ *
+ * \param[in] env     environment of the finished test
+ * \param[in] failed  non-zero if the test failed on any rank
+ *
+ * \return 0 on success
+ */
+int tst_cache_record (const struct tst_env * env, int failed);
+
+#endif  /* TST_CACHE_H_ */
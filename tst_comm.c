@@ -18,6 +18,17 @@
 
 #define COMM_NUM 32
 
+/*
+ * Room for "First %d processes of " preceding the description of a temporary communicator.
+ */
+#define COMM_DESCRIPTION_LEN (TST_DESCRIPTION_LEN + 32)
+
+/*
+ * The full graph has comm_size * (comm_size - 1) edges on every process,
+ * larger runs use the distributed graph communicators instead.
+ */
+#define TST_COMM_FULL_GRAPH_MAX 1024
+
 
 #define CHECK_ARG(i, ret) do {        \
   if ((i) < 0 || (i) > TST_COMMS_NUM) \
@@ -36,30 +47,58 @@ static const char * const tst_comms_class_strings [] =
     "CART_COMM",
     "TOPO_COMM"
 #if MPI_VERSION >= 3
-    , "SHARED_COMM"
+    , "SHARED_COMM",
+    "HW_COMM",
+    "INTER_NODE_COMM",
+    "DIST_GRAPH_COMM"
 #endif
   };
 
 
+struct comm;
+
+typedef int (*tst_comm_create_func) (struct comm *comm);
+
 struct comm {
   MPI_Comm mpi_comm;                       /* The actual MPI communicator */
   MPI_Comm *mpi_thread_comms;              /* List of duplicate MPI communicators used for threads */
-  char description [TST_DESCRIPTION_LEN];  /* The communicator's description */
+  char description [COMM_DESCRIPTION_LEN]; /* The communicator's description */
   int class;                               /* Class of communicator */
   int size;                                /* Size of this communicator */
+  int min_size;                            /* Smallest size of this communicator over all processes */
   int * mapping;                           /* Our mapping of the communicator */
   int other_size;                          /* In case of intra-comms, the size of the other communicator */
   int * other_mapping;                     /* In case of intra-comms, the mapping of the other communicator */
+  tst_comm_create_func create;             /* Builds the MPI communicator on first use */
+  int created;                             /* Whether the MPI communicator has been built */
 };
 
 static int num_registered_comms = 0;
 
 static struct comm comms[COMM_NUM];
 
+static int tst_comm_degree = 4;     /* Number of neighbors in the k-nearest ring and random regular graph */
+
 
-int tst_comm_init(struct comm *comm) {
+/*
+ * Duplicate the communicator for every thread and agree on its smallest size.
+ */
+static int tst_comm_setup(struct comm *comm) {
   int i;
   int num_threads = tst_thread_num_threads();
+  int local_size = INT_MAX;
+  int min_size;
+
+  /*
+   * Communicators may differ in size between the processes or not include
+   * all of them, all processes have to agree on the tests to be run though.
+   */
+  if (MPI_COMM_NULL != comm->mpi_comm) {
+    MPI_CHECK (MPI_Comm_size(comm->mpi_comm, &local_size));
+  }
+  MPI_CHECK (MPI_Allreduce(&local_size, &min_size, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+  comm->min_size = (INT_MAX == min_size) ? 0 : min_size;
+
   comm->mpi_thread_comms = (MPI_Comm *) malloc(num_threads * sizeof(MPI_Comm));
   for (i = 0; i < num_threads; i++) {
     if(comm->mpi_comm != MPI_COMM_NULL) {
@@ -69,24 +108,102 @@ int tst_comm_init(struct comm *comm) {
       comm->mpi_thread_comms[i] = MPI_COMM_NULL;
     }
   }
+  comm->created = 1;
   return 0;
 }
 
-int tst_comm_register(char *description, MPI_Comm mpi_comm, int class, int size, int *mapping, int other_size, int *other_mapping) {
+/*
+ * Build the communicator on first use, collective over MPI_COMM_WORLD.
+ */
+static struct comm * tst_comm_get(int i) {
+  if (!comms[i].created) {
+    tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Creating comm %s\n",
+                       tst_global_rank, comms[i].description);
+    comms[i].create(&comms[i]);
+    tst_comm_setup(&comms[i]);
+  }
+  return &comms[i];
+}
+
+int tst_comm_register(char *description, int class, tst_comm_create_func create) {
   assert(num_registered_comms < COMM_NUM);
-  strncpy(comms[num_registered_comms].description, description, TST_DESCRIPTION_LEN);
-  comms[num_registered_comms].mpi_comm = mpi_comm;
+  strncpy(comms[num_registered_comms].description, description, COMM_DESCRIPTION_LEN - 1);
+  comms[num_registered_comms].mpi_comm = MPI_COMM_NULL;
   comms[num_registered_comms].class = class;
-  comms[num_registered_comms].size = size;
-  comms[num_registered_comms].mapping = mapping;
-  comms[num_registered_comms].other_size = other_size;
-  comms[num_registered_comms].other_mapping = other_mapping;
+  comms[num_registered_comms].create = create;
+  comms[num_registered_comms].created = 0;
   num_registered_comms++;
   return 0;
 }
 
 
-int tst_comm_register_comm_world() {
+int tst_comm_split_halves(MPI_Comm parent, MPI_Comm *newcomm) {
+  int size;
+  int rank;
+  MPI_CHECK (MPI_Comm_size(parent, &size));
+  MPI_CHECK (MPI_Comm_rank(parent, &rank));
+  MPI_CHECK (MPI_Comm_split(parent, rank >= size / 2, rank, newcomm));
+  return 0;
+}
+
+int tst_comm_reversed_group(MPI_Comm parent, MPI_Group *group) {
+  int size;
+  int i;
+  int *ranks;
+  MPI_Group parent_group;
+  MPI_CHECK (MPI_Comm_size(parent, &size));
+  if ((ranks = malloc (size * sizeof(int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < size; i++)
+    ranks[i] = size - 1 - i;
+  MPI_CHECK (MPI_Comm_group(parent, &parent_group));
+  MPI_CHECK (MPI_Group_incl(parent_group, size, ranks, group));
+  MPI_CHECK (MPI_Group_free(&parent_group));
+  free(ranks);
+  return 0;
+}
+
+int tst_comm_inter_halves(MPI_Comm parent, MPI_Comm half, int tag, MPI_Comm *newcomm) {
+  int size;
+  int rank;
+  MPI_CHECK (MPI_Comm_size(parent, &size));
+  MPI_CHECK (MPI_Comm_rank(parent, &rank));
+  /*
+   * Only the remote_leader given by the local leaders matters, i.e. by the first process of either half.
+   */
+  MPI_CHECK (MPI_Intercomm_create(half, 0, parent, (rank < size / 2) ? size / 2 : 0, tag, newcomm));
+  return 0;
+}
+
+int tst_comm_cart(MPI_Comm parent, int ndims, const int *periods, int reorder, MPI_Comm *newcomm) {
+  int size;
+  int dims[3] = {0, 0, 0};         /* Set to zero in order to receive value */
+  if (ndims < 1 || ndims > 3)
+    ERROR (EINVAL, "Cartesian communicators have 1 to 3 dimensions");
+  MPI_CHECK (MPI_Comm_size(parent, &size));
+  MPI_CHECK (MPI_Dims_create(size, ndims, dims));
+  MPI_CHECK (MPI_Cart_create(parent, ndims, dims, (int *) periods, reorder, newcomm));
+  return 0;
+}
+
+
+int tst_comm_checkcomm(const struct tst_env *env, MPI_Comm comm, int size, int rank) {
+  int comm_size;
+  int comm_rank;
+  MPI_CHECK (MPI_Comm_size(comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank(comm, &comm_rank));
+  if ((size >= 0 && comm_size != size) || (rank >= 0 && comm_rank != rank)) {
+    if (tst_report >= TST_REPORT_FULL) {
+      printf ("(Rank:%d) Expected communicator of size %d with rank %d, got size %d with rank %d\n",
+              tst_global_rank, size, rank, comm_size, comm_rank);
+    }
+    tst_test_recordfailure (env);
+  }
+  return 0;
+}
+
+
+static int tst_comm_create_comm_world(struct comm *comm) {
   int comm_size = 1;
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
   int i;
@@ -97,26 +214,29 @@ int tst_comm_register_comm_world() {
   for (i = 0; i < comm_size; i++) {
     mapping[i] = i;
   }
-  tst_comm_register("MPI_COMM_WORLD", MPI_COMM_WORLD, TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
+  comm->mpi_comm = MPI_COMM_WORLD;
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
-int tst_comm_register_comm_null() {
-  tst_comm_register("MPI_COMM_NULL", MPI_COMM_NULL, TST_MPI_COMM_NULL, 0, NULL, 0, NULL);
+static int tst_comm_create_comm_null(struct comm *comm) {
+  comm->mpi_comm = MPI_COMM_NULL;
+  comm->size = 0;
   return 0;
 }
 
-int tst_comm_register_comm_self() {
-  tst_comm_register("MPI_COMM_SELF", MPI_COMM_SELF, TST_MPI_COMM_SELF, 1, NULL, 0, NULL);
+static int tst_comm_create_comm_self(struct comm *comm) {
+  comm->mpi_comm = MPI_COMM_SELF;
+  comm->size = 1;
   return 0;
 }
 
-int tst_comm_register_duplicate_comm_world() {
-  MPI_Comm comm;
+static int tst_comm_create_duplicate_comm_world(struct comm *comm) {
   int comm_size = 1;
   int i;
-  MPI_CHECK (MPI_Comm_dup (MPI_COMM_WORLD, &comm));
-  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_dup (MPI_COMM_WORLD, &comm->mpi_comm));
+  MPI_CHECK (MPI_Comm_size (comm->mpi_comm, &comm_size));
   int *mapping = (int *) malloc(comm_size * sizeof(int));
   if (NULL == mapping) {
     ERROR (errno, "malloc");
@@ -130,21 +250,21 @@ int tst_comm_register_duplicate_comm_world() {
     int tmp_size; int comm_size;
     MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &comm_rank);
-    MPI_Comm_size(comm, &tmp_size);
-    MPI_Comm_rank(comm, &tmp_rank);
+    MPI_Comm_size(comm->mpi_comm, &tmp_size);
+    MPI_Comm_rank(comm->mpi_comm, &tmp_rank);
     if (tmp_size != comm_size || tmp_rank != comm_rank)
       ERROR (EINVAL, "CHECK for Reversed MPI_COMM_WORLD failed");
   );
 
-  tst_comm_register("Duplicated MPI_COMM_WORLD", comm, TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
-int tst_comm_register_reversed_comm_world() {
-  MPI_Comm comm;
+static int tst_comm_create_reversed_comm_world(struct comm *comm) {
   int comm_size = 1;
   int i;
-  MPI_Group tmp_group, tmp_group2;
+  MPI_Group tmp_group;
 
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
   int *mapping = (int *) malloc(comm_size * sizeof(int));
@@ -154,38 +274,34 @@ int tst_comm_register_reversed_comm_world() {
   for (i = 1; i <= comm_size; i++) {
     mapping[i - 1] = comm_size - i;
   }
-  MPI_CHECK (MPI_Comm_group(MPI_COMM_WORLD, &tmp_group));
-  MPI_CHECK (MPI_Group_incl(tmp_group, comm_size, mapping, &tmp_group2));
-  MPI_CHECK (MPI_Comm_create(MPI_COMM_WORLD, tmp_group2, &comm));
+  tst_comm_reversed_group(MPI_COMM_WORLD, &tmp_group);
+  MPI_CHECK (MPI_Comm_create(MPI_COMM_WORLD, tmp_group, &comm->mpi_comm));
   MPI_CHECK (MPI_Group_free(&tmp_group));
-  MPI_CHECK (MPI_Group_free(&tmp_group2));
-  MPI_CHECK (MPI_Comm_size(comm, &comm_size));
+  MPI_CHECK (MPI_Comm_size(comm->mpi_comm, &comm_size));
 
   INTERNAL_CHECK (
     int tmp_rank; int comm_rank;
     int tmp_size; int comm_size;
     MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
     MPI_Comm_rank(MPI_COMM_WORLD, &comm_rank);
-    MPI_Comm_size(comm, &tmp_size);
-    MPI_Comm_rank(comm, &tmp_rank);
+    MPI_Comm_size(comm->mpi_comm, &tmp_size);
+    MPI_Comm_rank(comm->mpi_comm, &tmp_rank);
     if (tmp_size != comm_size || tmp_rank != comm_size - comm_rank-1)
       ERROR (EINVAL, "CHECK for Reversed MPI_COMM_WORLD failed");
   );
 
-  tst_comm_register("Reversed MPI_COMM_WORLD", comm, TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
 
-int tst_comm_register_halved_comm_world() {
-  MPI_Comm comm;
+static int tst_comm_create_halved_comm_world(struct comm *comm) {
   int comm_size = 1;
   int i;
   int world_size = -1;
-  int world_rank = -1;
 
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
-  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
   comm_size = world_size / 2;
   int *mapping = (int *) malloc(comm_size * sizeof(int));
   if (NULL == mapping) {
@@ -195,67 +311,58 @@ int tst_comm_register_halved_comm_world() {
   for (i = 0; i < comm_size; i++) {
     mapping[i] = i;
   }
-  MPI_CHECK (MPI_Comm_split (MPI_COMM_WORLD, world_rank >= comm_size,
-                               world_rank, &comm));
+  tst_comm_split_halves(MPI_COMM_WORLD, &comm->mpi_comm);
   /** \todo WATCH OUT, ONE process may contain MPI_COMM_NULL */
-  MPI_CHECK (MPI_Comm_size(comm, &comm_size));
+  MPI_CHECK (MPI_Comm_size(comm->mpi_comm, &comm_size));
 
-  tst_comm_register("Halved MPI_COMM_WORLD", comm, TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
 
-int tst_comm_register_2D_cart_comm() {
+static int tst_comm_create_2D_cart_comm(struct comm *comm) {
   int comm_size;
+  int i;
+  const int periods[2] = {1, 1};
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
-  if (comm_size > 1) {
-    MPI_Comm comm;
-    int i;
-    int dims[2] = {0, 0};
-    int periods[2] = {1, 1};
-    int *mapping = (int *) malloc(comm_size * sizeof(int));
-    if (NULL == mapping) {
-      ERROR (errno, "malloc");
-    }
-    /** \todo Check mapping definition */
-    for (i = 0; i < comm_size; i++) {
-      mapping[i] = i;
-    }
-    MPI_CHECK (MPI_Dims_create(comm_size, 2, dims));
-    MPI_CHECK (MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &comm));
-
-    tst_comm_register("2D Cart_comm", comm, TST_MPI_CART_COMM, comm_size, mapping, 0, NULL);
+  int *mapping = (int *) malloc(comm_size * sizeof(int));
+  if (NULL == mapping) {
+    ERROR (errno, "malloc");
+  }
+  /** \todo Check mapping definition */
+  for (i = 0; i < comm_size; i++) {
+    mapping[i] = i;
   }
+  tst_comm_cart(MPI_COMM_WORLD, 2, periods, 1, &comm->mpi_comm);
+
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
 
-int tst_comm_register_3D_cart_comm() {
+static int tst_comm_create_3D_cart_comm(struct comm *comm) {
   int comm_size;
+  int i;
+  const int periods[3] = {0, 0, 0};
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
-  if (comm_size > 1) {
-    MPI_Comm comm;
-    int i;
-    int dims[3] = {0, 0, 0};         /* Set to zero in order to receive value */
-    int periods[3] = {0, 0, 0};
-    int *mapping = (int *) malloc(comm_size * sizeof(int));
-    if (NULL == mapping) {
-      ERROR (errno, "malloc");
-    }
-    /** \todo Check mapping definition */
-    for (i = 0; i < comm_size; i++) {
-      mapping[i] = i;
-    }
-    MPI_CHECK(MPI_Dims_create(comm_size, 3, dims));
-    MPI_CHECK(MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 1, &comm));
-
-    tst_comm_register("3D Cart_comm", comm, TST_MPI_CART_COMM, comm_size, mapping, 0, NULL);
+  int *mapping = (int *) malloc(comm_size * sizeof(int));
+  if (NULL == mapping) {
+    ERROR (errno, "malloc");
   }
+  /** \todo Check mapping definition */
+  for (i = 0; i < comm_size; i++) {
+    mapping[i] = i;
+  }
+  tst_comm_cart(MPI_COMM_WORLD, 3, periods, 1, &comm->mpi_comm);
+
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
-int tst_comm_register_odd_even_split() {
-  MPI_Comm comm;
+static int tst_comm_create_odd_even_split(struct comm *comm) {
   int i;
   int comm_size = 1;
   int world_size = -1;
@@ -264,8 +371,8 @@ int tst_comm_register_odd_even_split() {
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
   MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
 
-  MPI_CHECK (MPI_Comm_split(MPI_COMM_WORLD, world_rank % 2, world_rank, &comm));
-  MPI_CHECK (MPI_Comm_size(comm, &comm_size));
+  MPI_CHECK (MPI_Comm_split(MPI_COMM_WORLD, world_rank % 2, world_rank, &comm->mpi_comm));
+  MPI_CHECK (MPI_Comm_size(comm->mpi_comm, &comm_size));
 
   int *mapping = (int *) malloc(comm_size * sizeof(int));
   if (NULL == mapping) {
@@ -275,12 +382,12 @@ int tst_comm_register_odd_even_split() {
     mapping[i] = i*2 + (world_rank % 2);
   }
 
-  tst_comm_register("Odd/Even split MPI_COMM_WORLD", comm, TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
-int tst_comm_register_fully_connected_topology() {
-  MPI_Comm comm;
+static int tst_comm_create_fully_connected_topology(struct comm *comm) {
   int i;
   int comm_size = 1;
 
@@ -313,12 +420,13 @@ int tst_comm_register_fully_connected_topology() {
       num++;
     }
   }
-  MPI_CHECK (MPI_Graph_create(MPI_COMM_WORLD, comm_size, index, edges, 1, &comm));
+  MPI_CHECK (MPI_Graph_create(MPI_COMM_WORLD, comm_size, index, edges, 1, &comm->mpi_comm));
 
   free(index);
   free(edges);
 
-  tst_comm_register("Full-connected Topology", comm, TST_MPI_TOPO_COMM, comm_size, mapping, 0, NULL);
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
@@ -327,96 +435,74 @@ int tst_comm_register_fully_connected_topology() {
  * Create a halved inter-communicator with all processes < comm_size/2 on one side
  * and all the others on the other side!
  */
-int tst_comm_register_halved_inter_comm() {
+static int tst_comm_create_halved_inter_comm(struct comm *comm) {
   int world_size;
+  int i;
+  MPI_Comm tmp_comm;
   MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
+  tst_comm_split_halves(MPI_COMM_WORLD, &tmp_comm);
 
-  if (world_size > 1) {
-    int i;
-    MPI_Comm comm;
-    MPI_Comm tmp_comm;
-    int world_rank;
-    MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
-    MPI_CHECK (MPI_Comm_split(MPI_COMM_WORLD, world_rank >= world_size / 2, world_rank, &tmp_comm));
-
-    int comm_size;
-    MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
-    int other_size = world_size - comm_size;
-
-    int *mapping;
-    if ((mapping = malloc (comm_size * sizeof(int))) == NULL)
-      ERROR (errno, "malloc");
-    for (i = 0; i < comm_size; i++)
-      mapping[i] = i;
+  int comm_size;
+  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
+  int other_size = world_size - comm_size;
 
-    int *other_mapping;
-    if ((other_mapping = malloc (other_size * sizeof(int))) == NULL)
-      ERROR (errno, "malloc");
-    for (i = 0; i < other_size; i++)
-      other_mapping[i] = comm_size + i;
-
-    /*
-     * The MPI-standard doesn't require the remote_leader to be the same on all processes.
-     * Here, we specify for process zero the correct value, all others
-     * (including the process world_size/2 gets the value 0 -- which is correct for him, but
-     * not the others).
-     *
-     * More correct would be: (comm_rank < comm_size/2 ? comm_size/2 : 0).
-     */
-    MPI_CHECK (MPI_Intercomm_create(tmp_comm,
-                                    0,
-                                    MPI_COMM_WORLD,
-                                    (world_rank == 0) ? world_size / 2 : 0,
-                                    num_registered_comms,
-                                    &comm));
-
-    MPI_CHECK (MPI_Comm_free (&tmp_comm));
-
-    tst_comm_register("Halved Inter_communicator", comm, TST_MPI_INTER_COMM, comm_size, mapping, other_size, other_mapping);
-  }
+  int *mapping;
+  if ((mapping = malloc (comm_size * sizeof(int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < comm_size; i++)
+    mapping[i] = i;
+
+  int *other_mapping;
+  if ((other_mapping = malloc (other_size * sizeof(int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < other_size; i++)
+    other_mapping[i] = comm_size + i;
+
+  tst_comm_inter_halves(MPI_COMM_WORLD, tmp_comm, (int) (comm - comms), &comm->mpi_comm);
+
+  MPI_CHECK (MPI_Comm_free (&tmp_comm));
+
+  comm->size = comm_size;
+  comm->mapping = mapping;
+  comm->other_size = other_size;
+  comm->other_mapping = other_mapping;
   return 0;
 }
 
-int tst_comm_register_merged_inter_comm() {
-  int world_size;
-  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
-
-  if (world_size > 1) {
-    /* Create an Intra-communicator merged out of the "Halved Inter_communicator" communicator */
-    int i;
-    MPI_Comm comm;
-    int halved_inter_comm_Id;
-    for(halved_inter_comm_Id = 0; halved_inter_comm_Id <num_registered_comms; halved_inter_comm_Id++) {
-      if (strcmp("Halved Inter_communicator", comms[halved_inter_comm_Id].description) == 0) {
-        break;
-      }
+static int tst_comm_create_merged_inter_comm(struct comm *comm) {
+  /* Create an Intra-communicator merged out of the "Halved Inter_communicator" communicator */
+  int i;
+  int halved_inter_comm_Id;
+  for(halved_inter_comm_Id = 0; halved_inter_comm_Id <num_registered_comms; halved_inter_comm_Id++) {
+    if (strcmp("Halved Inter_communicator", comms[halved_inter_comm_Id].description) == 0) {
+      break;
     }
+  }
 
-    int comm_size;
-    MPI_CHECK (MPI_Intercomm_merge(comms[halved_inter_comm_Id].mpi_comm, 0, &comm));
-    MPI_CHECK (MPI_Comm_size(comm, &comm_size));
+  int comm_size;
+  MPI_CHECK (MPI_Intercomm_merge(tst_comm_get(halved_inter_comm_Id)->mpi_comm, 0, &comm->mpi_comm));
+  MPI_CHECK (MPI_Comm_size(comm->mpi_comm, &comm_size));
 
-    int *mapping;
-    if ((mapping = malloc (comm_size * sizeof(int))) == NULL)
-      ERROR (errno, "malloc");
-    for (i = 0; i < comm_size; i++)
-      mapping[i] = i;
+  int *mapping;
+  if ((mapping = malloc (comm_size * sizeof(int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < comm_size; i++)
+    mapping[i] = i;
 
-    tst_comm_register("Intracomm merged of the Halved Inter_communicator", comm, TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
-  }
+  comm->size = comm_size;
+  comm->mapping = mapping;
   return 0;
 }
 
 
-int tst_comm_register_split_type_shared() {
 #if MPI_VERSION >= 3
+static int tst_comm_create_split_type_shared(struct comm *comm) {
   int i;
-  MPI_Comm comm;
   int comm_size;
   int world_rank;
   MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
-  MPI_CHECK (MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &comm));
-  MPI_CHECK(MPI_Comm_size(comm, &comm_size));
+  MPI_CHECK (MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &comm->mpi_comm));
+  MPI_CHECK(MPI_Comm_size(comm->mpi_comm, &comm_size));
   int *mapping;
   if ((mapping = malloc (comm_size * sizeof(int))) == NULL) {
     ERROR (errno, "malloc");
@@ -425,35 +511,322 @@ int tst_comm_register_split_type_shared() {
     mapping[i] = i;
   }
 
-  tst_comm_register("MPI_COMM_TYPE_SHARED comm", comm, TST_MPI_SHARED_COMM | TST_MPI_INTRA_COMM, comm_size, mapping, 0, NULL);
+  comm->size = comm_size;
+  comm->mapping = mapping;
+  return 0;
+}
+
+
+/*
+ * Returns the ranks in MPI_COMM_WORLD of the processes of comm, NULL for MPI_COMM_NULL.
+ */
+static int * tst_comm_world_mapping(MPI_Comm comm, int *comm_size) {
+  int world_rank;
+  int *mapping;
+
+  *comm_size = 0;
+  if (MPI_COMM_NULL == comm)
+    return NULL;
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+  MPI_CHECK (MPI_Comm_size(comm, comm_size));
+  if ((mapping = malloc (*comm_size * sizeof(int))) == NULL) {
+    ERROR (errno, "malloc");
+  }
+  MPI_CHECK (MPI_Allgather(&world_rank, 1, MPI_INT, mapping, 1, MPI_INT, comm));
+  return mapping;
+}
+
+
+/*
+ * Returns the rank of this process within its node.
+ */
+static int tst_comm_node_rank() {
+  MPI_Comm node_comm;
+  int node_rank;
+  MPI_CHECK (MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm));
+  MPI_CHECK (MPI_Comm_rank(node_comm, &node_rank));
+  MPI_CHECK (MPI_Comm_free(&node_comm));
+  return node_rank;
+}
+
+
+/*
+ * The first process of every node, the others get MPI_COMM_NULL.
+ */
+static int tst_comm_create_node_leaders(struct comm *comm) {
+  int world_rank;
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+  MPI_CHECK (MPI_Comm_split(MPI_COMM_WORLD, tst_comm_node_rank() == 0 ? 0 : MPI_UNDEFINED, world_rank, &comm->mpi_comm));
+  comm->mapping = tst_comm_world_mapping(comm->mpi_comm, &comm->size);
+  return 0;
+}
+
+
+/*
+ * The processes with the same rank within their node, i.e. one process of every node,
+ * on nodes with fewer processes some of them are left out.
+ */
+static int tst_comm_create_cross_node(struct comm *comm) {
+  int world_rank;
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+  MPI_CHECK (MPI_Comm_split(MPI_COMM_WORLD, tst_comm_node_rank(), world_rank, &comm->mpi_comm));
+  comm->mapping = tst_comm_world_mapping(comm->mpi_comm, &comm->size);
+  return 0;
+}
+
+
+#if MPI_VERSION >= 4 || defined(OPEN_MPI)
+#define TST_COMM_HW_SPLIT
+/*
+ * Split MPI_COMM_WORLD by a hardware resource, with MPI_COMM_TYPE_HW_GUIDED as of MPI-4,
+ * or with Open MPI's own split types. If the resource is unknown to any process,
+ * all get MPI_COMM_NULL and the tests are skipped.
+ */
+static int tst_comm_create_split_type_hw(struct comm *comm, const char *resource_type, int split_type) {
+  int world_rank;
+  int have_comm;
+  int have_comm_all;
+
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+#if MPI_VERSION >= 4
+  {
+    MPI_Info info;
+    (void) split_type;
+    MPI_CHECK (MPI_Info_create(&info));
+    MPI_CHECK (MPI_Info_set(info, "mpi_hw_resource_type", resource_type));
+    MPI_CHECK (MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_HW_GUIDED, world_rank, info, &comm->mpi_comm));
+    MPI_CHECK (MPI_Info_free(&info));
+  }
+#else
+  (void) resource_type;
+  MPI_CHECK (MPI_Comm_split_type(MPI_COMM_WORLD, split_type, world_rank, MPI_INFO_NULL, &comm->mpi_comm));
 #endif
+
+  have_comm = (MPI_COMM_NULL != comm->mpi_comm);
+  MPI_CHECK (MPI_Allreduce(&have_comm, &have_comm_all, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+  if (!have_comm_all && MPI_COMM_NULL != comm->mpi_comm) {
+    MPI_CHECK (MPI_Comm_free(&comm->mpi_comm));
+  }
+  comm->mapping = tst_comm_world_mapping(comm->mpi_comm, &comm->size);
   return 0;
 }
 
 
-int tst_comms_init() {
+static int tst_comm_create_per_socket(struct comm *comm) {
+#if MPI_VERSION >= 4
+  return tst_comm_create_split_type_hw(comm, "Package", MPI_UNDEFINED);
+#else
+  return tst_comm_create_split_type_hw(comm, "Package", OMPI_COMM_TYPE_SOCKET);
+#endif
+}
+
+
+static int tst_comm_create_per_numa(struct comm *comm) {
+#if MPI_VERSION >= 4
+  return tst_comm_create_split_type_hw(comm, "NUMANode", MPI_UNDEFINED);
+#else
+  return tst_comm_create_split_type_hw(comm, "NUMANode", OMPI_COMM_TYPE_NUMA);
+#endif
+}
+#endif
+#endif
+
+
+int tst_comms_init(const int *comm_list, int comm_list_num) {
   int i;
-  for (i = 0; i < num_registered_comms; i++) {
-    tst_comm_init(&comms[i]);
+  for (i = 0; i < comm_list_num; i++) {
+    tst_comm_get(comm_list[i]);
   }
-  return num_registered_comms;
+  return comm_list_num;
+}
+
+#if MPI_VERSION >= 3
+static int tst_comm_cmp_int(const void *a, const void *b) {
+  return *(const int *) a - *(const int *) b;
+}
+
+/*
+ * Build a symmetric distributed graph from the neighbors of this process only.
+ * Sorted neighbors allow tests to exchange with one neighbor after the other without deadlock.
+ */
+static int tst_comm_create_dist_graph(struct comm *comm, int *neighbors, int neighbors_num) {
+  int *weights;
+  int world_size;
+  int i;
+
+  /*
+   * All edges weigh the same, real weights avoid handing the sentinel MPI_UNWEIGHTED as array.
+   */
+  if ((weights = malloc((neighbors_num + 1) * sizeof(int))) == NULL) {
+    ERROR (errno, "malloc");
+  }
+  for (i = 0; i < neighbors_num; i++) {
+    weights[i] = 1;
+  }
+
+  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
+  qsort(neighbors, neighbors_num, sizeof(int), tst_comm_cmp_int);
+  MPI_CHECK (MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+                                            neighbors_num, neighbors, weights,
+                                            neighbors_num, neighbors, weights,
+                                            MPI_INFO_NULL, 0, &comm->mpi_comm));
+  free(weights);
+  free(neighbors);
+
+  if ((comm->mapping = malloc (world_size * sizeof(int))) == NULL) {
+    ERROR (errno, "malloc");
+  }
+  for (i = 0; i < world_size; i++) {
+    comm->mapping[i] = i;
+  }
+  comm->size = world_size;
+  return 0;
 }
 
+/*
+ * Every process is connected to the degree/2 nearest processes on either side.
+ */
+static int tst_comm_create_ring_graph(struct comm *comm) {
+  int world_size;
+  int world_rank;
+  int *neighbors;
+  int i;
+
+  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+  if ((neighbors = malloc (tst_comm_degree * sizeof(int))) == NULL) {
+    ERROR (errno, "malloc");
+  }
+  for (i = 0; i < tst_comm_degree / 2; i++) {
+    neighbors[2 * i] = (world_rank + i + 1) % world_size;
+    neighbors[2 * i + 1] = ((world_rank - i - 1) % world_size + world_size) % world_size;
+  }
+  return tst_comm_create_dist_graph(comm, neighbors, tst_comm_degree);
+}
+
+static unsigned long long tst_comm_random(unsigned long long *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/*
+ * The union of degree/2 random Hamiltonian cycles, a random regular multigraph.
+ * All processes draw the same cycles, taking O(comm_size) memory at a time.
+ */
+static int tst_comm_create_random_graph(struct comm *comm) {
+  unsigned long long state = 0x9E3779B97F4A7C15ULL;
+  int world_size;
+  int world_rank;
+  int *neighbors;
+  int *cycle;
+  int i, j;
+
+  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+  if ((neighbors = malloc (tst_comm_degree * sizeof(int))) == NULL ||
+      (cycle = malloc (world_size * sizeof(int))) == NULL) {
+    ERROR (errno, "malloc");
+  }
+  for (i = 0; i < tst_comm_degree / 2; i++) {
+    for (j = 0; j < world_size; j++) {
+      cycle[j] = j;
+    }
+    for (j = world_size - 1; j > 0; j--) {
+      const int k = (int) (tst_comm_random(&state) % (unsigned long long) (j + 1));
+      const int tmp = cycle[j];
+      cycle[j] = cycle[k];
+      cycle[k] = tmp;
+    }
+    for (j = 0; cycle[j] != world_rank; j++)
+      ;
+    neighbors[2 * i] = cycle[(j + 1) % world_size];
+    neighbors[2 * i + 1] = cycle[(j + world_size - 1) % world_size];
+  }
+  free(cycle);
+  return tst_comm_create_dist_graph(comm, neighbors, tst_comm_degree);
+}
+
+/*
+ * The 7-point stencil on a periodic 3D grid, i.e. the two neighbors in every dimension.
+ */
+static int tst_comm_create_torus_graph(struct comm *comm) {
+  int world_size;
+  int world_rank;
+  int dims[3] = {0, 0, 0};
+  int coords[3];
+  int *neighbors;
+  int d;
+
+  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
+  MPI_CHECK (MPI_Comm_rank(MPI_COMM_WORLD, &world_rank));
+  MPI_CHECK (MPI_Dims_create(world_size, 3, dims));
+  coords[0] = world_rank / (dims[1] * dims[2]);
+  coords[1] = (world_rank / dims[2]) % dims[1];
+  coords[2] = world_rank % dims[2];
+  if ((neighbors = malloc (6 * sizeof(int))) == NULL) {
+    ERROR (errno, "malloc");
+  }
+  for (d = 0; d < 3; d++) {
+    int up[3];
+    int down[3];
+    memcpy(up, coords, sizeof(coords));
+    memcpy(down, coords, sizeof(coords));
+    up[d] = (coords[d] + 1) % dims[d];
+    down[d] = (coords[d] + dims[d] - 1) % dims[d];
+    neighbors[2 * d] = (up[0] * dims[1] + up[1]) * dims[2] + up[2];
+    neighbors[2 * d + 1] = (down[0] * dims[1] + down[1]) * dims[2] + down[2];
+  }
+  return tst_comm_create_dist_graph(comm, neighbors, 6);
+}
+#endif
+
+
+int tst_comm_setdegree(int degree) {
+  if (degree < 2 || degree % 2)
+    ERROR (EINVAL, "Degree of the graph communicators must be even and at least 2");
+  tst_comm_degree = degree;
+  return 0;
+}
+
+/*
+ * Only records the communicators, which are built on first use.
+ */
 int tst_comms_register() {
+  int world_size;
+  MPI_CHECK (MPI_Comm_size(MPI_COMM_WORLD, &world_size));
 
-  tst_comm_register_comm_world();
-  tst_comm_register_comm_null();
-  tst_comm_register_comm_self();
-  tst_comm_register_duplicate_comm_world();
-  tst_comm_register_reversed_comm_world();
-  tst_comm_register_halved_comm_world();
-  tst_comm_register_2D_cart_comm();
-  tst_comm_register_3D_cart_comm();
-  tst_comm_register_odd_even_split();
-  tst_comm_register_fully_connected_topology();
-  tst_comm_register_halved_inter_comm();
-  tst_comm_register_merged_inter_comm();
-  tst_comm_register_split_type_shared();
+  tst_comm_register("MPI_COMM_WORLD", TST_MPI_INTRA_COMM, tst_comm_create_comm_world);
+  tst_comm_register("MPI_COMM_NULL", TST_MPI_COMM_NULL, tst_comm_create_comm_null);
+  tst_comm_register("MPI_COMM_SELF", TST_MPI_COMM_SELF, tst_comm_create_comm_self);
+  tst_comm_register("Duplicated MPI_COMM_WORLD", TST_MPI_INTRA_COMM, tst_comm_create_duplicate_comm_world);
+  tst_comm_register("Reversed MPI_COMM_WORLD", TST_MPI_INTRA_COMM, tst_comm_create_reversed_comm_world);
+  tst_comm_register("Halved MPI_COMM_WORLD", TST_MPI_INTRA_COMM, tst_comm_create_halved_comm_world);
+  if (world_size > 1) {
+    tst_comm_register("2D Cart_comm", TST_MPI_CART_COMM, tst_comm_create_2D_cart_comm);
+    tst_comm_register("3D Cart_comm", TST_MPI_CART_COMM, tst_comm_create_3D_cart_comm);
+  }
+  tst_comm_register("Odd/Even split MPI_COMM_WORLD", TST_MPI_INTRA_COMM, tst_comm_create_odd_even_split);
+  if (world_size <= TST_COMM_FULL_GRAPH_MAX) {
+    tst_comm_register("Full-connected Topology", TST_MPI_TOPO_COMM, tst_comm_create_fully_connected_topology);
+  }
+  if (world_size > 1) {
+    tst_comm_register("Halved Inter_communicator", TST_MPI_INTER_COMM, tst_comm_create_halved_inter_comm);
+    tst_comm_register("Intracomm merged of the Halved Inter_communicator", TST_MPI_INTRA_COMM, tst_comm_create_merged_inter_comm);
+  }
+#if MPI_VERSION >= 3
+  tst_comm_register("MPI_COMM_TYPE_SHARED comm", TST_MPI_SHARED_COMM | TST_MPI_INTRA_COMM, tst_comm_create_split_type_shared);
+  tst_comm_register("Node leaders comm", TST_MPI_INTER_NODE_COMM | TST_MPI_INTRA_COMM, tst_comm_create_node_leaders);
+  tst_comm_register("Cross-node comm", TST_MPI_INTER_NODE_COMM | TST_MPI_INTRA_COMM, tst_comm_create_cross_node);
+  tst_comm_register("Dist_graph k-nearest ring", TST_MPI_DIST_GRAPH_COMM | TST_MPI_TOPO_COMM, tst_comm_create_ring_graph);
+  tst_comm_register("Dist_graph random regular", TST_MPI_DIST_GRAPH_COMM | TST_MPI_TOPO_COMM, tst_comm_create_random_graph);
+  tst_comm_register("Dist_graph 3D torus stencil", TST_MPI_DIST_GRAPH_COMM | TST_MPI_TOPO_COMM, tst_comm_create_torus_graph);
+#ifdef TST_COMM_HW_SPLIT
+  tst_comm_register("Per-socket comm", TST_MPI_HW_COMM | TST_MPI_SHARED_COMM | TST_MPI_INTRA_COMM, tst_comm_create_per_socket);
+  tst_comm_register("Per-NUMA comm", TST_MPI_HW_COMM | TST_MPI_SHARED_COMM | TST_MPI_INTRA_COMM, tst_comm_create_per_numa);
+#endif
+#endif
 
   return num_registered_comms;
 
@@ -627,10 +1000,62 @@ int tst_comms_register() {
 }
 
 
+int tst_comm_register_scratch(int commId, int size) {
+  MPI_Comm comm = MPI_COMM_NULL;
+  char description[COMM_DESCRIPTION_LEN];
+  int *mapping = NULL;
+  int scratchId = num_registered_comms;
+  int rank;
+  int i;
+
+  if (num_registered_comms >= COMM_NUM)
+    ERROR (EINVAL, "Too many communicators, increase COMM_NUM");
+
+  if (MPI_COMM_NULL != tst_comm_get(commId)->mpi_comm) {
+    MPI_CHECK (MPI_Comm_rank(comms[commId].mpi_comm, &rank));
+    MPI_CHECK (MPI_Comm_split(comms[commId].mpi_comm, rank < size ? 0 : MPI_UNDEFINED, rank, &comm));
+  }
+  if (NULL != comms[commId].mapping) {
+    if (NULL == (mapping = (int *) malloc(size * sizeof(int)))) {
+      ERROR (errno, "malloc");
+    }
+    for (i = 0; i < size; i++) {
+      mapping[i] = comms[commId].mapping[i];
+    }
+  }
+  snprintf(description, COMM_DESCRIPTION_LEN, "First %d processes of %s", size, comms[commId].description);
+
+  tst_comm_register(description, TST_MPI_INTRA_COMM, NULL);
+  comms[scratchId].mpi_comm = comm;
+  comms[scratchId].size = size;
+  comms[scratchId].mapping = mapping;
+  tst_comm_setup(&comms[scratchId]);
+  return scratchId;
+}
+
+int tst_comm_free_scratch(int commId) {
+  int j;
+  if (commId != num_registered_comms - 1)
+    ERROR (EINVAL, "Only the communicator registered last may be freed");
+
+  if (MPI_COMM_NULL != comms[commId].mpi_comm) {
+    MPI_Comm_free(&comms[commId].mpi_comm);
+    for (j = 0; j < tst_thread_num_threads(); j++) {
+      MPI_Comm_free(&comms[commId].mpi_thread_comms[j]);
+    }
+  }
+  free(comms[commId].mpi_thread_comms);
+  free(comms[commId].mapping);
+  memset(&comms[commId], 0, sizeof(struct comm));
+  num_registered_comms--;
+  return 0;
+}
+
+
 int tst_comm_cleanup () {
   int i;
   for (i = 0; i < num_registered_comms; i++) {
-    if (NULL == ((void*)comms[i].mpi_comm) || MPI_COMM_NULL == comms[i].mpi_comm)
+    if (!comms[i].created || NULL == ((void*)comms[i].mpi_comm) || MPI_COMM_NULL == comms[i].mpi_comm)
       continue;
 
     free(comms[i].mapping);
@@ -649,17 +1074,17 @@ MPI_Comm tst_comm_getcomm (int i) {
   CHECK_ARG (i, MPI_COMM_NULL);
   int threadId = tst_thread_get_num();
   if (threadId == TST_THREAD_MASTER) {
-    return comms[i].mpi_comm;
+    return tst_comm_get(i)->mpi_comm;
   }
   else {
-    return comms[i].mpi_thread_comms[threadId];
+    return tst_comm_get(i)->mpi_thread_comms[threadId];
   }
 }
 
 
 MPI_Comm tst_comm_getmastercomm (int i) {
   CHECK_ARG (i, MPI_COMM_NULL);
-  return comms[i].mpi_comm;
+  return tst_comm_get(i)->mpi_comm;
 }
 
 int tst_comm_getcommsize (int i)
@@ -667,13 +1092,20 @@ int tst_comm_getcommsize (int i)
   int size;
   CHECK_ARG (i, -1);
   /* XXX Niethammer: Some log output calls this also with MPI_COMM_NULL. */
-  if(MPI_COMM_NULL == comms[i].mpi_comm) {
+  if(MPI_COMM_NULL == tst_comm_get(i)->mpi_comm) {
     return 0;
   }
   MPI_Comm_size (comms[i].mpi_comm, &size);
   return size;
 }
 
+int tst_comm_getminsize (int i)
+{
+  CHECK_ARG (i, -1);
+
+  return tst_comm_get(i)->min_size;
+}
+
 int tst_comm_getcommclass (int i)
 {
   CHECK_ARG (i, -1);
@@ -3,18 +3,33 @@
 
 #include <mpi.h>
 
+struct tst_env;
 
 /** \brief register communicators
+ *
+ * Only records how to build every communicator, the MPI communicators and
+ * their duplicates for the threads are built on first use.
  *
  * \return number of registered communicators
  */
 int tst_comms_register() ;
 
-/** \brief initialize communicators
+/** \brief Set the number of neighbors of the k-nearest ring and random regular graph communicators
+ *
+ * \param[in]  degree  number of neighbors, even and at least 2
+ * \return 0 on success
+ */
+int tst_comm_setdegree(int degree);
+
+/** \brief initialize the selected communicators
  *
+ * Collective over MPI_COMM_WORLD, every process has to pass the same list.
+ *
+ * \param[in]  comm_list      ids of the selected communicators
+ * \param[in]  comm_list_num  number of selected communicators
  * \return number of initialized communicators
  */
-int tst_comms_init();
+int tst_comms_init(const int *comm_list, int comm_list_num);
 
 /** \brief return thread private MPI communicator for given communicator
  *
@@ -31,4 +46,74 @@ MPI_Comm tst_comm_getcomm (int commId);
 MPI_Comm tst_comm_getmastercomm(int commId);
 
 
+/** \brief Register a temporary communicator of the first processes of an intra-communicator
+ *
+ * Collective over MPI_COMM_WORLD, the processes not included get MPI_COMM_NULL.
+ *
+ * \param[in]  commId  id of the intra-communicator
+ * \param[in]  size    number of processes of the temporary communicator
+ * \return id of the temporary communicator
+ */
+int tst_comm_register_scratch(int commId, int size);
+
+/** \brief Free the temporary communicator registered last
+ *
+ * \param[in]  commId  id of the temporary communicator
+ * \return 0 on success
+ */
+int tst_comm_free_scratch(int commId);
+
+
+/** \brief Split a communicator into its lower and upper half
+ *
+ * Used to build the halved communicators, collective over parent.
+ *
+ * \param[in]  parent   intra-communicator to be split
+ * \param[out] newcomm  half of parent including the calling process
+ * \return 0 on success
+ */
+int tst_comm_split_halves(MPI_Comm parent, MPI_Comm *newcomm);
+
+/** \brief Get the group of a communicator's processes in reversed order
+ *
+ * \param[in]  parent  intra-communicator
+ * \param[out] group   group to be freed by the caller
+ * \return 0 on success
+ */
+int tst_comm_reversed_group(MPI_Comm parent, MPI_Group *group);
+
+/** \brief Connect the halves of a communicator by an inter-communicator
+ *
+ * \param[in]  parent   intra-communicator of at least two processes
+ * \param[in]  half     half of parent built by tst_comm_split_halves
+ * \param[in]  tag      tag of the communication between the leaders in parent
+ * \param[out] newcomm  inter-communicator between the lower and upper half
+ * \return 0 on success
+ */
+int tst_comm_inter_halves(MPI_Comm parent, MPI_Comm half, int tag, MPI_Comm *newcomm);
+
+/** \brief Arrange the processes of a communicator in a balanced Cartesian grid
+ *
+ * \param[in]  parent   intra-communicator
+ * \param[in]  ndims    number of dimensions, 1 to 3
+ * \param[in]  periods  whether every dimension is periodic
+ * \param[in]  reorder  whether the processes may be reordered
+ * \param[out] newcomm  Cartesian communicator
+ * \return 0 on success
+ */
+int tst_comm_cart(MPI_Comm parent, int ndims, const int *periods, int reorder, MPI_Comm *newcomm);
+
+/** \brief Check the size of a new communicator and the rank of this process in it
+ *
+ * Records a failure of the test on a mismatch.
+ *
+ * \param[in]  env   environment of the test
+ * \param[in]  comm  new communicator, for an inter-communicator its local group is checked
+ * \param[in]  size  expected size, -1 for any
+ * \param[in]  rank  expected rank, -1 for any
+ * \return 0 on success
+ */
+int tst_comm_checkcomm(const struct tst_env *env, MPI_Comm comm, int size, int rank);
+
+
 #endif  /* TST_COMM_H_ */
@@ -0,0 +1,56 @@
+#include "config.h"
+
+#include "tst_count.h"
+
+#include <limits.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+
+
+/* Number of values per contiguous chunk of the derived datatype */
+#define TST_COUNT_CHUNK ((tst_count) 1 << 30)
+
+
+int tst_count_gettype (int type, tst_count count, MPI_Datatype * datatype, int * num)
+{
+  const MPI_Datatype base = tst_type_getdatatype (type);
+  MPI_Datatype chunk;
+  MPI_Datatype types[2];
+  MPI_Aint displs[2];
+  int blocklens[2];
+  MPI_Aint lb;
+  MPI_Aint extent;
+
+  if (count <= INT_MAX)
+    {
+      *datatype = base;
+      *num = (int) count;
+      return 0;
+    }
+
+  MPI_CHECK (MPI_Type_get_extent (base, &lb, &extent));
+  MPI_CHECK (MPI_Type_contiguous ((int) TST_COUNT_CHUNK, base, &chunk));
+
+  blocklens[0] = (int) (count / TST_COUNT_CHUNK);
+  blocklens[1] = (int) (count % TST_COUNT_CHUNK);
+  displs[0] = 0;
+  displs[1] = (MPI_Aint) (count / TST_COUNT_CHUNK) * TST_COUNT_CHUNK * extent;
+  types[0] = chunk;
+  types[1] = base;
+
+  MPI_CHECK (MPI_Type_create_struct (blocklens[1] > 0 ? 2 : 1, blocklens, displs, types, datatype));
+  MPI_CHECK (MPI_Type_commit (datatype));
+  MPI_CHECK (MPI_Type_free (&chunk));
+  *num = 1;
+  return 0;
+}
+
+
+int tst_count_freetype (int type, MPI_Datatype * datatype)
+{
+  if (*datatype != tst_type_getdatatype (type))
+    MPI_CHECK (MPI_Type_free (datatype));
+  *datatype = MPI_DATATYPE_NULL;
+  return 0;
+}
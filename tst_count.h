@@ -0,0 +1,33 @@
+#ifndef TST_COUNT_H_
+#define TST_COUNT_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Describe a number of values, which may exceed INT_MAX, by an int count
+ *
+ * For libraries without the MPI-4 large-count functions: up to INT_MAX values
+ * are described by the datatype itself and the number of values; more values
+ * by one element of a derived datatype consisting of contiguous chunks of the
+ * datatype and the remaining values. Only for datatypes whose extent equals
+ * their size.
+ *
+ * \param[in]  type      datatype of the values
+ * \param[in]  count     number of values
+ * \param[out] datatype  datatype to be communicated
+ * \param[out] num       number of elements of datatype to be communicated
+ *
+ * \return 0 on success
+ */
+int tst_count_gettype (int type, tst_count count, MPI_Datatype * datatype, int * num);
+
+/** \brief Free a datatype returned by tst_count_gettype
+ *
+ * \param[in]     type      datatype of the values
+ * \param[in,out] datatype  datatype returned by tst_count_gettype
+ *
+ * \return 0 on success
+ */
+int tst_count_freetype (int type, MPI_Datatype * datatype);
+
+#endif  /* TST_COUNT_H_ */
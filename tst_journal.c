@@ -0,0 +1,264 @@
+#include "config.h"
+
+#include "tst_journal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_plan.h"
+
+
+#define TST_JOURNAL_LINE_MAX 1024
+
+struct tst_journal_entry {
+  char * key;     /* Tab-separated names of the test */
+  int seq;        /* Position in the journals read, later results supersede earlier ones */
+  int failed;     /* Whether the test failed */
+};
+
+static FILE * tst_journal = NULL;
+
+
+void tst_journal_getkey (const struct tst_env * env, char * key, int len)
+{
+  int ret;
+
+  ret = snprintf (key, len, "%s\t%s\t%s\t%s\t%lld",
+                  tst_test_getclass_string (env->test),
+                  tst_test_getdescription (env->test),
+                  tst_comm_getdescription (env->comm),
+                  tst_type_getdescription (env->type),
+                  (long long) env->values_count);
+  /*
+   * The keys of tests without buffer offset stay the same as before offsets were swept.
+   */
+  if (env->buffer_offset != 0 && ret >= 0 && ret < len)
+    snprintf (key + ret, len - ret, "@%d", env->buffer_offset);
+}
+
+
+static int tst_journal_cmp_entry (const void * a, const void * b)
+{
+  const struct tst_journal_entry * ea = a;
+  const struct tst_journal_entry * eb = b;
+  int ret = strcmp (ea->key, eb->key);
+  return ret ? ret : (ea->seq > eb->seq) - (ea->seq < eb->seq);
+}
+
+
+/*
+ * Append the entries of a journal to the array entries.
+ */
+static void tst_journal_read (const char * filename, struct tst_journal_entry ** entries,
+                              int * entries_num, int * entries_max)
+{
+  char line[TST_JOURNAL_LINE_MAX];
+  char * result;
+  FILE * file;
+
+  if ((file = fopen (filename, "r")) == NULL)
+    ERROR (errno, "Could not open journal");
+
+  while (fgets (line, sizeof (line), file) != NULL)
+    {
+      line[strcspn (line, "\n")] = '\0';
+      if (line[0] == '#' || line[0] == '\0')
+        continue;
+      if ((result = strrchr (line, '\t')) == NULL)
+        ERROR (EINVAL, "Malformed line in journal");
+      *result++ = '\0';
+
+      if (*entries_num == *entries_max)
+        {
+          *entries_max = (*entries_max == 0) ? 1024 : 2 * *entries_max;
+          *entries = realloc (*entries, *entries_max * sizeof (struct tst_journal_entry));
+          if (*entries == NULL)
+            ERROR (errno, "realloc");
+        }
+      if (((*entries)[*entries_num].key = strdup (line)) == NULL)
+        ERROR (errno, "strdup");
+      (*entries)[*entries_num].seq = *entries_num;
+      (*entries)[*entries_num].failed = !strcmp (result, "failed");
+      (*entries_num)++;
+    }
+  fclose (file);
+}
+
+
+int tst_journal_init (const char * filename)
+{
+  if (filename == NULL)
+    return 0;
+  if (tst_global_rank != 0)
+    return 0;
+
+  if ((tst_journal = fopen (filename, "a")) == NULL)
+    ERROR (errno, "Could not open journal");
+  if (ftell (tst_journal) == 0)
+    fprintf (tst_journal, "# class\ttest\tcomm\ttype\tvalues_num[@offset]\tresult\n");
+  fflush (tst_journal);
+  return 0;
+}
+
+
+int tst_journal_cleanup (void)
+{
+  if (tst_journal != NULL)
+    fclose (tst_journal);
+  tst_journal = NULL;
+  return 0;
+}
+
+
+int tst_journal_record (const struct tst_env * env, int failed)
+{
+  char key[TST_JOURNAL_LINE_MAX];
+
+  if (tst_journal == NULL)
+    return 0;
+
+  tst_journal_getkey (env, key, sizeof (key));
+  fprintf (tst_journal, "%s\t%s\n", key, failed ? "failed" : "passed");
+  /*
+   * The journal has to survive the failure of the node.
+   */
+  fflush (tst_journal);
+  fsync (fileno (tst_journal));
+  return 0;
+}
+
+
+int tst_journal_resume (const char * filename)
+{
+  struct tst_journal_entry * entries = NULL;
+  struct tst_env env;
+  char key[TST_JOURNAL_LINE_MAX];
+  int entries_num = 0;
+  int entries_max = 0;
+  int num_plan;
+  int * keep;
+  int i;
+
+  num_plan = tst_plan_getnum ();
+  if ((keep = malloc ((num_plan + 1) * sizeof (int))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < num_plan; i++)
+    keep[i] = 1;
+
+  if (tst_global_rank == 0)
+    {
+      tst_journal_read (filename, &entries, &entries_num, &entries_max);
+      qsort (entries, entries_num, sizeof (struct tst_journal_entry), tst_journal_cmp_entry);
+
+      for (i = 0; i < num_plan; i++)
+        {
+          int lo, hi, mid;
+
+          tst_plan_getenv (i, &env);
+          tst_journal_getkey (&env, key, sizeof (key));
+
+          /*
+           * Find the last entry of the key, a test run again supersedes its earlier results.
+           */
+          lo = 0;
+          hi = entries_num;
+          while (lo < hi)
+            {
+              mid = (lo + hi) / 2;
+              if (strcmp (entries[mid].key, key) <= 0)
+                lo = mid + 1;
+              else
+                hi = mid;
+            }
+          if (lo == 0 || strcmp (entries[lo - 1].key, key))
+            continue;
+          keep[i] = 0;
+          if (entries[lo - 1].failed)
+            tst_test_recordfailure (&env);
+        }
+
+      for (i = 0; i < entries_num; i++)
+        free (entries[i].key);
+      free (entries);
+    }
+
+  MPI_CHECK (MPI_Bcast (keep, num_plan, MPI_INT, 0, MPI_COMM_WORLD));
+  i = num_plan - tst_plan_filter (keep);
+  free (keep);
+
+  if (tst_global_rank == 0 && tst_report >= TST_REPORT_RUN)
+    printf ("Resuming from journal %s, skipping %d finished tests\n", filename, i);
+  return i;
+}
+
+
+int tst_journal_merge (const char * filenames)
+{
+  struct tst_journal_entry * entries = NULL;
+  int entries_num = 0;
+  int entries_max = 0;
+  int num_journals = 0;
+  int num_tests = 0;
+  int num_failed = 0;
+  char * list;
+  char * filename;
+  int i;
+
+  if ((list = strdup (filenames)) == NULL)
+    ERROR (errno, "strdup");
+  for (filename = strtok (list, ","); filename != NULL; filename = strtok (NULL, ","))
+    {
+      tst_journal_read (filename, &entries, &entries_num, &entries_max);
+      num_journals++;
+    }
+  free (list);
+
+  qsort (entries, entries_num, sizeof (struct tst_journal_entry), tst_journal_cmp_entry);
+
+  /*
+   * A test journaled more than once failed, if it failed in any run.
+   */
+  for (i = 0; i < entries_num; i++)
+    {
+      if (i > 0 && !strcmp (entries[i].key, entries[i - 1].key))
+        {
+          if (entries[i].failed && !entries[i - 1].failed)
+            num_failed++;
+          entries[i].failed |= entries[i - 1].failed;
+          entries[i - 1].failed = 0;
+          continue;
+        }
+      num_tests++;
+      num_failed += entries[i].failed;
+    }
+
+  printf ("Merged %d journals with %d tests\n", num_journals, num_tests);
+  printf ("Number of failed tests: %d\n", num_failed);
+  if (num_failed > 0)
+    {
+      printf ("Summary of failed tests:\n");
+      for (i = 0; i < entries_num; i++)
+        {
+          char * field[5];
+          int j;
+
+          if (!entries[i].failed)
+            continue;
+          field[0] = strtok (entries[i].key, "\t");
+          for (j = 1; j < 5; j++)
+            field[j] = strtok (NULL, "\t");
+          printf ("ERROR class:%s test:%s, comm %s, type %s number of values:%s\n",
+                  field[0], field[1], field[2], field[3], field[4]);
+        }
+    }
+
+  for (i = 0; i < entries_num; i++)
+    free (entries[i].key);
+  free (entries);
+  return num_failed;
+}
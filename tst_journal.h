@@ -0,0 +1,65 @@
+#ifndef TST_JOURNAL_H_
+#define TST_JOURNAL_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Open the progress journal
+ *
+ * Rank 0 appends every finished test with its result to the journal,
+ * one line of tab-separated test-class, test, comm, datatype, number of
+ * values (followed by @offset for a non-zero buffer offset) and result.
+ * A test failed, if it failed on any rank. Has to be called by all ranks.
+ *
+ * \param[in] filename  name of the journal, NULL disables the journal
+ *
+ * \return 0 on success
+ */
+int tst_journal_init (const char * filename);
+
+/** \brief Close the progress journal */
+int tst_journal_cleanup (void);
+
+/** \brief Get the tab-separated names identifying a test in a journal
+ *
+ * \param[in]  env  environment of the test
+ * \param[out] key  buffer for the names
+ * \param[in]  len  size of the buffer
+ */
+void tst_journal_getkey (const struct tst_env * env, char * key, int len);
+
+/** \brief Append a finished test to the journal
+ *
+ * Only rank 0 writes the journal.
+ *
+ * \param[in] env     environment of the finished test
+ * \param[in] failed  non-zero if the test failed on any rank
+ *
+ * \return 0 on success
+ */
+int tst_journal_record (const struct tst_env * env, int failed);
+
+/** \brief Remove the tests finished in a previous run from the plan
+ *
+ * Rank 0 reads the journal of a previous run, records the failures of
+ * the finished tests and broadcasts which entries of the plan to skip.
+ * Therefore this function has to be called by all ranks.
+ *
+ * \param[in] filename  name of the journal of the previous run
+ *
+ * \return number of entries removed from the plan
+ */
+int tst_journal_resume (const char * filename);
+
+/** \brief Print the combined summary of the journals of several runs
+ *
+ * Used to merge the results of the shards of a test run, a test journaled
+ * in several runs is failed, if it failed in any of them.
+ *
+ * \param[in] filenames  comma-separated list of journals
+ *
+ * \return number of failed tests
+ */
+int tst_journal_merge (const char * filenames);
+
+#endif  /* TST_JOURNAL_H_ */
@@ -0,0 +1,234 @@
+#include "config.h"
+
+#include "tst_neighbor.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+
+
+int tst_neighbor_count (MPI_Comm comm, int * indegree, int * outdegree)
+{
+  int topology;
+  int comm_rank;
+  int ndims;
+
+  MPI_CHECK (MPI_Topo_test (comm, &topology));
+  switch (topology)
+    {
+      case MPI_CART:
+        /*
+         * Two neighbors per dimension, the ones at the boundary may be MPI_PROC_NULL.
+         */
+        MPI_CHECK (MPI_Cartdim_get (comm, &ndims));
+        *indegree = *outdegree = 2 * ndims;
+        break;
+      case MPI_GRAPH:
+        MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+        MPI_CHECK (MPI_Graph_neighbors_count (comm, comm_rank, indegree));
+        *outdegree = *indegree;
+        break;
+#if MPI_VERSION >= 3
+      case MPI_DIST_GRAPH:
+        {
+          int weighted;
+          MPI_CHECK (MPI_Dist_graph_neighbors_count (comm, indegree, outdegree, &weighted));
+        }
+        break;
+#endif
+      default:
+        ERROR (EINVAL, "Communicator has no topology");
+    }
+  return 0;
+}
+
+
+int tst_neighbor_init (struct tst_env * env)
+{
+  MPI_Comm comm;
+  int topology;
+  int indegree;
+  int outdegree;
+  int comm_rank;
+  int i;
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+  if ((env->recv_from = malloc ((indegree + 1) * sizeof (int))) == NULL ||
+      (env->send_to = malloc ((outdegree + 1) * sizeof (int))) == NULL ||
+      (env->req_buffer = malloc ((indegree + outdegree + 1) * sizeof (MPI_Request))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < indegree + outdegree + 1; i++)
+    env->req_buffer[i] = MPI_REQUEST_NULL;
+
+  MPI_CHECK (MPI_Topo_test (comm, &topology));
+  if (topology == MPI_CART)
+    {
+      /*
+       * For every dimension the neighbor in negative, then the one in positive direction.
+       */
+      for (i = 0; i < indegree / 2; i++)
+        MPI_CHECK (MPI_Cart_shift (comm, i, 1, &env->recv_from[2 * i], &env->recv_from[2 * i + 1]));
+      for (i = 0; i < outdegree; i++)
+        env->send_to[i] = env->recv_from[i];
+    }
+  else if (topology == MPI_GRAPH)
+    {
+      MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+      MPI_CHECK (MPI_Graph_neighbors (comm, comm_rank, indegree, env->recv_from));
+      for (i = 0; i < outdegree; i++)
+        env->send_to[i] = env->recv_from[i];
+    }
+#if MPI_VERSION >= 3
+  else
+    {
+      int * weights;
+
+      if ((weights = malloc ((indegree + outdegree + 1) * sizeof (int))) == NULL)
+        ERROR (errno, "malloc");
+      MPI_CHECK (MPI_Dist_graph_neighbors (comm, indegree, env->recv_from, weights,
+                                           outdegree, env->send_to, weights + indegree));
+      free (weights);
+    }
+#endif
+  return 0;
+}
+
+
+MPI_Request * tst_neighbor_request (struct tst_env * env)
+{
+  int indegree;
+  int outdegree;
+
+  tst_neighbor_count (tst_comm_getcomm (env->comm), &indegree, &outdegree);
+  return &env->req_buffer[indegree + outdegree];
+}
+
+
+int tst_neighbor_cleanup (struct tst_env * env)
+{
+  free (env->recv_from);
+  free (env->send_to);
+  free (env->req_buffer);
+  env->recv_from = NULL;
+  env->send_to = NULL;
+  env->req_buffer = NULL;
+  return 0;
+}
+
+
+int tst_neighbor_exchange (struct tst_env * env, const char * send_buffer, MPI_Aint send_stride,
+                           char * recv_buffer, MPI_Aint recv_stride)
+{
+  MPI_Comm comm;
+  MPI_Datatype type;
+  int indegree;
+  int outdegree;
+  int i;
+
+  comm = tst_comm_getcomm (env->comm);
+  type = tst_type_getdatatype (env->type);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+
+  /*
+   * Several blocks from the same neighbor carry the same values, so one tag suffices.
+   */
+  for (i = 0; i < indegree; i++)
+    MPI_CHECK (MPI_Irecv (recv_buffer + i * recv_stride, env->values_num, type,
+                          env->recv_from[i], env->tag, comm, &env->req_buffer[i]));
+  for (i = 0; i < outdegree; i++)
+    MPI_CHECK (MPI_Isend ((char *) send_buffer + i * send_stride, env->values_num, type,
+                          env->send_to[i], env->tag, comm, &env->req_buffer[indegree + i]));
+  MPI_CHECK (MPI_Waitall (indegree + outdegree, env->req_buffer, MPI_STATUSES_IGNORE));
+  return 0;
+}
+
+
+/*
+ * Seed of the block on edge i of this process, an outgoing edge to neighbors[i] or,
+ * if incoming, an edge from neighbors[i]. The seed depends on the sender and on the
+ * edge as the sender sees it, so a block delivered to the wrong destination or in the
+ * wrong slot is detected. For Cartesian topologies this is the direction, the block
+ * from the neighbor in negative direction having been sent in positive direction;
+ * if both neighbors of a dimension are the same process, the order of its two blocks
+ * is not defined and both carry the seed of the dimension. For graph topologies the
+ * receiver is not told the position of the edge in the sender's neighbor list, so
+ * the receiving rank is used instead.
+ */
+static int tst_neighbor_seed (const struct tst_env * env, MPI_Comm comm, const int * neighbors,
+                              int i, int incoming)
+{
+  int topology;
+  int comm_size;
+  int comm_rank;
+  int sender;
+  int key;
+
+  MPI_CHECK (MPI_Topo_test (comm, &topology));
+  MPI_CHECK (MPI_Comm_size (comm, &comm_size));
+  MPI_CHECK (MPI_Comm_rank (comm, &comm_rank));
+  sender = incoming ? neighbors[i] : comm_rank;
+  if (topology == MPI_CART)
+    {
+      if (neighbors[i & ~1] == neighbors[i | 1])
+        key = i & ~1;
+      else
+        key = incoming ? i ^ 1 : i;
+    }
+  else
+    key = incoming ? comm_rank : neighbors[i];
+
+  /*
+   * Kept low enough for the seed plus the index of the last value not to overflow an int.
+   */
+  return (int) ((((tst_count) key + 1) * comm_size + sender) % (INT_MAX - env->values_num));
+}
+
+
+int tst_neighbor_setblocks (struct tst_env * env, char * send_buffer, MPI_Aint send_stride)
+{
+  MPI_Comm comm;
+  int indegree;
+  int outdegree;
+  int i;
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+  for (i = 0; i < outdegree; i++)
+    tst_type_setstandardarray (env->type, env->values_num, send_buffer + i * send_stride,
+                               tst_neighbor_seed (env, comm, env->send_to, i, 0));
+  return 0;
+}
+
+
+int tst_neighbor_checkblocks (struct tst_env * env, char * recv_buffer, MPI_Aint recv_stride)
+{
+  MPI_Comm comm;
+  int indegree;
+  int outdegree;
+  int i;
+
+  comm = tst_comm_getcomm (env->comm);
+  tst_neighbor_count (comm, &indegree, &outdegree);
+  for (i = 0; i < indegree; i++)
+    if (env->recv_from[i] != MPI_PROC_NULL)
+      tst_test_checkstandardarray (env, recv_buffer + i * recv_stride,
+                                   tst_neighbor_seed (env, comm, env->recv_from, i, 1));
+  return 0;
+}
+
+
+int tst_neighbor_checkgathered (struct tst_env * env, char * recv_buffer, MPI_Aint recv_stride)
+{
+  int indegree;
+  int outdegree;
+  int i;
+
+  tst_neighbor_count (tst_comm_getcomm (env->comm), &indegree, &outdegree);
+  for (i = 0; i < indegree; i++)
+    if (env->recv_from[i] != MPI_PROC_NULL)
+      tst_test_checkstandardarray (env, recv_buffer + i * recv_stride, env->recv_from[i]);
+  return 0;
+}
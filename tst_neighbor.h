@@ -0,0 +1,90 @@
+#ifndef TST_NEIGHBOR_H_
+#define TST_NEIGHBOR_H_
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+
+
+/** \brief Get the number of neighbors of this process in a topology communicator
+ *
+ * Works with Cartesian, graph and distributed graph communicators.
+ *
+ * \param[in]  comm       topology communicator
+ * \param[out] indegree   number of sources
+ * \param[out] outdegree  number of destinations
+ *
+ * \return 0 on success
+ */
+int tst_neighbor_count (MPI_Comm comm, int * indegree, int * outdegree);
+
+/** \brief Look up the neighbors of the test's communicator
+ *
+ * Sets env->recv_from to the sources and env->send_to to the destinations
+ * in the order of the neighborhood collectives, MPI_PROC_NULL at the
+ * boundaries of non-periodic Cartesian communicators, and allocates
+ * env->req_buffer with one request per neighbor plus one for a persistent
+ * collective.
+ *
+ * \param[in,out] env  environment of the test
+ *
+ * \return 0 on success
+ */
+int tst_neighbor_init (struct tst_env * env);
+
+/** \brief Get the request of a persistent neighborhood collective
+ *
+ * \param[in]  env  environment of the test, set up by tst_neighbor_init
+ *
+ * \return the request following the ones of the neighbors in env->req_buffer
+ */
+MPI_Request * tst_neighbor_request (struct tst_env * env);
+
+/** \brief Release the neighbors and requests of tst_neighbor_init */
+int tst_neighbor_cleanup (struct tst_env * env);
+
+/** \brief Exchange blocks of env->values_num values with all neighbors by MPI_Isend and MPI_Irecv
+ *
+ * The hand-rolled halo exchange equivalent to the neighborhood collectives.
+ *
+ * \param[in]  env          environment of the test
+ * \param[in]  send_buffer  block sent to the first destination
+ * \param[in]  send_stride  bytes between the blocks of the destinations, 0 sends the same block to all
+ * \param[out] recv_buffer  block received from the first source
+ * \param[in]  recv_stride  bytes between the blocks of the sources
+ *
+ * \return 0 on success
+ */
+int tst_neighbor_exchange (struct tst_env * env, const char * send_buffer, MPI_Aint send_stride,
+                           char * recv_buffer, MPI_Aint recv_stride);
+
+/** \brief Set the block sent to each destination to a standard array seeded by the edge
+ *
+ * \param[in]  env          environment of the test
+ * \param[out] send_buffer  block sent to the first destination
+ * \param[in]  send_stride  bytes between the blocks of the destinations
+ *
+ * \return 0 on success
+ */
+int tst_neighbor_setblocks (struct tst_env * env, char * send_buffer, MPI_Aint send_stride);
+
+/** \brief Check the blocks received from all sources against the ones set by tst_neighbor_setblocks
+ *
+ * \param[in]  env          environment of the test
+ * \param[in]  recv_buffer  block received from the first source
+ * \param[in]  recv_stride  bytes between the blocks of the sources
+ *
+ * \return 0 on success
+ */
+int tst_neighbor_checkblocks (struct tst_env * env, char * recv_buffer, MPI_Aint recv_stride);
+
+/** \brief Check the blocks received from all sources against the standard array of the source
+ *
+ * \param[in]  env          environment of the test
+ * \param[in]  recv_buffer  block received from the first source
+ * \param[in]  recv_stride  bytes between the blocks of the sources
+ *
+ * \return 0 on success
+ */
+int tst_neighbor_checkgathered (struct tst_env * env, char * recv_buffer, MPI_Aint recv_stride);
+
+#endif  /* TST_NEIGHBOR_H_ */
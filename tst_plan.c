@@ -0,0 +1,385 @@
+#include "config.h"
+
+#include "tst_plan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_comm.h"
+#include "tst_output.h"
+#include "tst_pool.h"
+#include "tst_values.h"
+
+
+/* Number of barriers timed to estimate the cost of synchronization */
+#define TST_PLAN_BARRIER_SAMPLES 16
+
+/* Dimensions of the test matrix: test, comm, type, number of values and buffer offset */
+#define TST_PLAN_DIMS 5
+
+struct tst_plan_entry {
+  int test;
+  int comm;
+  int type;
+  int values_num;
+  tst_count values_count;
+  int buffer_offset;
+  int tag;
+  int needs_sync;
+  int index[TST_PLAN_DIMS];    /* Position in the selection of every dimension */
+};
+
+static struct tst_plan_entry * tst_plan = NULL;
+static int tst_plan_num = 0;
+static int tst_plan_max = 0;
+static int tst_plan_concurrent = 0;
+static int tst_plan_dims[TST_PLAN_DIMS];
+
+
+static void tst_plan_add (const struct tst_env * env, const int * index, int needs_sync, int tag_ub, int tag_range)
+{
+  if (tst_plan_num == tst_plan_max)
+    {
+      tst_plan_max = (tst_plan_max == 0) ? 1024 : 2 * tst_plan_max;
+      tst_plan = realloc (tst_plan, tst_plan_max * sizeof (struct tst_plan_entry));
+      if (tst_plan == NULL)
+        ERROR (errno, "realloc");
+    }
+  tst_plan[tst_plan_num].test = env->test;
+  tst_plan[tst_plan_num].comm = env->comm;
+  tst_plan[tst_plan_num].type = env->type;
+  tst_plan[tst_plan_num].values_num = env->values_num;
+  tst_plan[tst_plan_num].values_count = env->values_count;
+  tst_plan[tst_plan_num].buffer_offset = env->buffer_offset;
+  /*
+   * Every entry gets its own range of tags, the threaded tests add the number of the thread.
+   */
+  tst_plan[tst_plan_num].tag = (tst_plan_num % (tag_ub / tag_range)) * tag_range;
+  tst_plan[tst_plan_num].needs_sync = needs_sync;
+  memcpy (tst_plan[tst_plan_num].index, index, sizeof (tst_plan[tst_plan_num].index));
+  tst_plan_num++;
+}
+
+
+int tst_plan_init (const int * tests, int num_tests,
+                   const int * comms, int num_comms,
+                   const int * types, int num_types,
+                   int num_values, int num_offsets,
+                   int tag_ub, int tag_range, int concurrent)
+{
+  struct tst_env env;
+  int index[TST_PLAN_DIMS];
+  int sync;
+  int i, j, k, l, m;
+
+  if (tag_range < 1 || tag_range > tag_ub)
+    ERROR (EINVAL, "Range of tags per test out of range");
+
+  memset (&env, 0, sizeof (env));
+  tst_plan_num = 0;
+  tst_plan_concurrent = concurrent;
+  tst_plan_dims[0] = num_tests;
+  tst_plan_dims[1] = num_comms;
+  tst_plan_dims[2] = num_types;
+  tst_plan_dims[3] = num_values;
+  tst_plan_dims[4] = num_offsets;
+
+  for (j = 0; j < num_comms; j++)
+    for (sync = 0; sync <= 1; sync++)
+      for (i = 0; i < num_tests; i++)
+        {
+          env.test = tests[i];
+          env.comm = comms[j];
+          if (tst_test_check_sync (&env) != sync)
+            continue;
+
+          for (k = 0; k < num_types; k++)
+            {
+              env.type = types[k];
+              if (!tst_test_check_run (&env))
+                {
+                  tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "Not planning test:%d comm:%d type:%d\n",
+                                     env.test, env.comm, env.type);
+                  continue;
+                }
+
+              for (l = 0; l < num_values; l++)
+                {
+                  env.values_count = tst_values_getcount (l, env.type);
+                  env.values_num = tst_values_getnum (l, env.type);
+                  /*
+                   * Only the large-count tests communicate more than INT_MAX values.
+                   */
+                  if (env.values_count > INT_MAX &&
+                      tst_test_getclass (env.test) != TST_CLASS_LARGE_COUNT)
+                    continue;
+                  /*
+                   * Sizes given in bytes may map to the same number of values of large datatypes.
+                   */
+                  if (l > 0 && env.values_count == tst_values_getcount (l - 1, env.type))
+                    continue;
+                  for (m = 0; m < num_offsets; m++)
+                    {
+                      env.buffer_offset = tst_pool_getoffset (m);
+                      index[0] = i;
+                      index[1] = j;
+                      index[2] = k;
+                      index[3] = l;
+                      index[4] = m;
+                      tst_plan_add (&env, index, sync, tag_ub, tag_range);
+                    }
+                }
+            }
+        }
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "(Rank:%d) Planned %d tests\n",
+                     tst_global_rank, tst_plan_num);
+  return tst_plan_num;
+}
+
+
+int tst_plan_cleanup (void)
+{
+  free (tst_plan);
+  tst_plan = NULL;
+  tst_plan_num = 0;
+  tst_plan_max = 0;
+  return 0;
+}
+
+
+int tst_plan_getnum (void)
+{
+  return tst_plan_num;
+}
+
+
+int tst_plan_filter (const int * keep)
+{
+  int num = 0;
+  int i;
+
+  for (i = 0; i < tst_plan_num; i++)
+    if (keep[i])
+      tst_plan[num++] = tst_plan[i];
+  tst_plan_num = num;
+  return tst_plan_num;
+}
+
+
+int tst_plan_shard (int shard, int num_shards)
+{
+  int num = 0;
+  int i;
+
+  if (num_shards < 1 || shard < 1 || shard > num_shards)
+    ERROR (EINVAL, "Shard has to be specified as k/n with 1 <= k <= n");
+
+  for (i = 0; i < tst_plan_num; i++)
+    if (i % num_shards == shard - 1)
+      tst_plan[num++] = tst_plan[i];
+  tst_plan_num = num;
+  return tst_plan_num;
+}
+
+
+/*
+ * Index of the combination of the dimensions in mask of an entry.
+ */
+static long tst_plan_getcombination (int entry, int mask)
+{
+  long combination = 0;
+  int d;
+
+  for (d = 0; d < TST_PLAN_DIMS; d++)
+    if (mask & (1 << d))
+      combination = combination * tst_plan_dims[d] + tst_plan[entry].index[d];
+  return combination;
+}
+
+
+int tst_plan_cover (int strength)
+{
+  char * covered[1 << TST_PLAN_DIMS];
+  int masks[1 << TST_PLAN_DIMS];
+  int num_masks = 0;
+  int threshold;
+  int * keep;
+  int mask;
+  int i, m;
+
+  if (strength < 1 || strength > TST_PLAN_DIMS)
+    ERROR (EINVAL, "Strength of coverage out of range");
+  if (strength == TST_PLAN_DIMS)
+    return tst_plan_num;
+
+  /*
+   * One bitmap of the covered combinations per subset of strength dimensions.
+   */
+  for (mask = 0; mask < (1 << TST_PLAN_DIMS); mask++)
+    {
+      long size = 1;
+      int num_dims = 0;
+      int d;
+
+      for (d = 0; d < TST_PLAN_DIMS; d++)
+        if (mask & (1 << d))
+          {
+            size *= tst_plan_dims[d];
+            num_dims++;
+          }
+      if (num_dims != strength)
+        continue;
+      if ((covered[num_masks] = calloc (size, sizeof (char))) == NULL)
+        ERROR (errno, "calloc");
+      masks[num_masks++] = mask;
+    }
+
+  if ((keep = calloc (tst_plan_num + 1, sizeof (int))) == NULL)
+    ERROR (errno, "calloc");
+
+  /*
+   * Greedily keep the entries covering the most combinations not covered yet,
+   * lowering the required number of new combinations in every pass.
+   * Only valid entries are considered, so the constraints of the tests hold.
+   */
+  for (threshold = num_masks; threshold >= 1; threshold--)
+    for (i = 0; i < tst_plan_num; i++)
+      {
+        int num_new = 0;
+
+        if (keep[i])
+          continue;
+        for (m = 0; m < num_masks; m++)
+          num_new += !covered[m][tst_plan_getcombination (i, masks[m])];
+        if (num_new < threshold)
+          continue;
+
+        keep[i] = 1;
+        for (m = 0; m < num_masks; m++)
+          covered[m][tst_plan_getcombination (i, masks[m])] = 1;
+      }
+
+  for (m = 0; m < num_masks; m++)
+    free (covered[m]);
+  tst_plan_filter (keep);
+  free (keep);
+  return tst_plan_num;
+}
+
+
+int tst_plan_getenv (int entry, struct tst_env * env)
+{
+  if (entry < 0 || entry >= tst_plan_num)
+    ERROR (EINVAL, "Entry of plan out of range");
+
+  /*
+   * Before setting the mandatory first fields needed, reset.
+   * Every test should clean up after itself.
+   */
+  memset (env, 0, sizeof (struct tst_env));
+  env->test       = tst_plan[entry].test;
+  env->values_num = tst_plan[entry].values_num;
+  env->values_count = tst_plan[entry].values_count;
+  env->type       = tst_plan[entry].type;
+  env->tag        = tst_plan[entry].tag;
+  env->comm       = tst_plan[entry].comm;
+  env->buffer_offset = tst_plan[entry].buffer_offset;
+  return 0;
+}
+
+
+static MPI_Comm tst_plan_getbarriercomm (int entry)
+{
+  MPI_Comm comm;
+
+  if (!tst_plan_concurrent)
+    return MPI_COMM_WORLD;
+  comm = tst_comm_getmastercomm (tst_plan[entry].comm);
+  return (comm == MPI_COMM_NULL) ? MPI_COMM_SELF : comm;
+}
+
+
+/*
+ * Returns the number of barriers needed before entry, executing them if execute is set.
+ */
+static int tst_plan_barriers (int entry, int execute)
+{
+  int prev_sync = entry > 0 && tst_plan[entry - 1].needs_sync;
+  int sync = entry < tst_plan_num && tst_plan[entry].needs_sync;
+  int num_barriers = 0;
+
+  if (prev_sync)
+    {
+      if (execute)
+        MPI_CHECK (MPI_Barrier (tst_plan_getbarriercomm (entry - 1)));
+      num_barriers++;
+    }
+
+  /*
+   * A barrier on the same communicator is shared with the previous entry.
+   */
+  if (sync && !(prev_sync && (!tst_plan_concurrent || tst_plan[entry - 1].comm == tst_plan[entry].comm)))
+    {
+      if (execute)
+        MPI_CHECK (MPI_Barrier (tst_plan_getbarriercomm (entry)));
+      num_barriers++;
+    }
+  return num_barriers;
+}
+
+
+int tst_plan_barrier (int entry)
+{
+  if (entry < 0 || entry > tst_plan_num)
+    ERROR (EINVAL, "Entry of plan out of range");
+  return tst_plan_barriers (entry, 1);
+}
+
+
+void tst_plan_print (void)
+{
+  double time_start;
+  double time_barrier;
+  double bytes = 0.0;
+  int num_barriers = 0;
+  int num_comm_switches = 0;
+  int i;
+
+  MPI_Barrier (MPI_COMM_WORLD);
+  time_start = MPI_Wtime ();
+  for (i = 0; i < TST_PLAN_BARRIER_SAMPLES; i++)
+    MPI_Barrier (MPI_COMM_WORLD);
+  time_barrier = (MPI_Wtime () - time_start) / TST_PLAN_BARRIER_SAMPLES;
+
+  if (tst_global_rank != 0)
+    return;
+
+  for (i = 0; i <= tst_plan_num; i++)
+    {
+      num_barriers += tst_plan_barriers (i, 0);
+      if (i == tst_plan_num)
+        break;
+      if (i > 0 && tst_plan[i].comm != tst_plan[i - 1].comm)
+        num_comm_switches++;
+      bytes += (double) tst_plan[i].values_count * tst_type_gettypesize (tst_plan[i].type) *
+        tst_comm_getcommsize (tst_plan[i].comm);
+
+      printf ("Plan %d: %s tests %s, comm %s, type %s, num values %lld, buffer offset %d%s\n", i,
+              tst_test_getclass_string (tst_plan[i].test),
+              tst_test_getdescription (tst_plan[i].test),
+              tst_comm_getdescription (tst_plan[i].comm),
+              tst_type_getdescription (tst_plan[i].type),
+              (long long) tst_plan[i].values_count, tst_plan[i].buffer_offset,
+              tst_plan[i].needs_sync ? " (sync)" : "");
+    }
+
+  printf ("Plan: %d tests, %d communicator switches, %d barriers (%.6f s each, %.3f s total), "
+          "%.0f bytes of values on all ranks\n",
+          tst_plan_num, num_comm_switches, num_barriers,
+          time_barrier, num_barriers * time_barrier, bytes);
+}
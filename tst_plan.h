@@ -0,0 +1,107 @@
+#ifndef TST_PLAN_H_
+#define TST_PLAN_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Build the execution plan of all runnable combinations
+ *
+ * Every combination of the selected tests, communicators, datatypes,
+ * number of values and buffer offsets, which passes tst_test_check_run,
+ * is entered into the plan.
+ * The plan is ordered by communicator; for every communicator the tests not
+ * needing synchronization precede the ones that do, so that consecutive
+ * synchronizing tests share their barriers.
+ *
+ * \param[in] tests       array of selected tests
+ * \param[in] num_tests   number of selected tests
+ * \param[in] comms       array of selected communicators
+ * \param[in] num_comms   number of selected communicators
+ * \param[in] types       array of selected datatypes
+ * \param[in] num_types   number of selected datatypes
+ * \param[in] num_values  number of entries in the list of number of values
+ * \param[in] num_offsets number of entries in the list of buffer offsets
+ * \param[in] tag_ub      upper bound of the tags assigned to the entries
+ * \param[in] tag_range   number of consecutive tags reserved for every entry
+ * \param[in] concurrent  non-zero to synchronize on the communicator of a test
+ *                        instead of MPI_COMM_WORLD
+ *
+ * \return number of entries in the plan
+ */
+int tst_plan_init (const int * tests, int num_tests,
+                   const int * comms, int num_comms,
+                   const int * types, int num_types,
+                   int num_values, int num_offsets,
+                   int tag_ub, int tag_range, int concurrent);
+
+/** \brief Release the execution plan */
+int tst_plan_cleanup (void);
+
+/** \brief Get the number of entries in the execution plan */
+int tst_plan_getnum (void);
+
+/** \brief Remove entries from the execution plan
+ *
+ * \param[in] keep  array of a flag per entry, whether to keep it in the plan
+ *
+ * \return number of entries in the plan
+ */
+int tst_plan_filter (const int * keep);
+
+/** \brief Reduce the execution plan to a covering array
+ *
+ * Keeps a subset of the entries, such that every combination of the values
+ * of any strength dimensions (test, comm, datatype, number of values and
+ * buffer offset), which occurs in the plan, is still covered by at least
+ * one entry. A strength of 5 keeps the full plan.
+ *
+ * \param[in] strength  number of dimensions whose combinations are covered
+ *
+ * \return number of entries in the plan
+ */
+int tst_plan_cover (int strength);
+
+/** \brief Restrict the execution plan to one of several shards
+ *
+ * The entries are dealt round-robin to the shards, so that every shard
+ * gets a similar mix of tests and communicators. All shards have to be
+ * run with the same selection and number of processes.
+ *
+ * \param[in] shard       number of the shard to keep, starting with 1
+ * \param[in] num_shards  number of shards
+ *
+ * \return number of entries in the plan
+ */
+int tst_plan_shard (int shard, int num_shards);
+
+/** \brief Initialize the environment of a test from an entry of the plan
+ *
+ * \param[in]  entry  index of the entry in the plan
+ * \param[out] env    environment to be reset and filled in
+ *
+ * \return 0 on success
+ */
+int tst_plan_getenv (int entry, struct tst_env * env);
+
+/** \brief Synchronize before an entry of the plan
+ *
+ * A test needing synchronization is preceded and followed by a barrier,
+ * consecutive tests share their barriers. The barriers are on MPI_COMM_WORLD,
+ * or in concurrent mode on the communicator of the test, so that tests on
+ * disjoint communicators are executed concurrently.
+ *
+ * \param[in] entry  index of the entry in the plan, or the number of entries
+ *                   for the barrier after the last entry
+ *
+ * \return number of barriers executed
+ */
+int tst_plan_barrier (int entry);
+
+/** \brief Print the execution plan and its estimated cost on rank 0
+ *
+ * The cost of the barriers is estimated by timing barriers on MPI_COMM_WORLD,
+ * therefore this function has to be called by all ranks.
+ */
+void tst_plan_print (void);
+
+#endif  /* TST_PLAN_H_ */
@@ -0,0 +1,428 @@
+#include "config.h"
+
+#include "tst_pool.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef HAVE_SYS_MMAN_H
+#  include <sys/mman.h>
+#endif
+#if defined(HAVE_NUMAIF_H) && defined(HAVE_MBIND)
+#  include <numaif.h>
+#  define TST_POOL_HAVE_NUMA 1
+#endif
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+
+
+#define TST_POOL_ALIGN        64   /* Alignment of the buffers handed out */
+#define TST_POOL_MIN_CLASS    6    /* Smallest size class holds 64 bytes */
+#define TST_POOL_CLASSES      (8 * sizeof (size_t))
+#define TST_POOL_MAX_NODES    1024
+#define TST_POOL_EXACT        TST_POOL_CLASSES        /* Free list of the blocks kept by their exact size */
+#define TST_POOL_EXACT_MIN    ((size_t) 1 << 20)      /* Larger buffers are not rounded up to a power of two */
+#define TST_POOL_BUDGET       ((size_t) 256 << 20)    /* Maximum number of bytes kept in the free lists */
+
+#define TST_POOL_2M           ((size_t) 1 << 21)
+#define TST_POOL_1G           ((size_t) 1 << 30)
+
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_SHIFT)
+#  define MAP_HUGE_SHIFT 26
+#endif
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_2MB)
+#  define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_1GB)
+#  define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+/*
+ * Every buffer is preceded by this header, padded to tst_pool_header bytes,
+ * and by the offset of the buffer. The offset is stored in the last bytes
+ * in front of the buffer, which lie in the padding of the header if the
+ * offset is smaller than a size_t.
+ */
+struct tst_pool_block {
+  struct tst_pool_block * next;   /* Next cached block of the same size class */
+  size_t size;                    /* Usable size of the block, without the header */
+  size_t map_size;                /* Size of the mapping, if allocated with mmap */
+  void * raw;                     /* Pointer returned by MPI_Alloc_mem, which does not guarantee our alignment */
+  int size_class;                 /* Index of the size class, TST_POOL_EXACT or -1 if not pooled */
+  int placement;                  /* Placement policy the block was allocated with */
+};
+
+static int tst_pool_mode = TST_POOL_ON;
+static int tst_pool_placement = TST_POOL_PLACEMENT_DEFAULT;
+static int tst_pool_node = 0;
+static size_t tst_pool_header = TST_POOL_ALIGN;   /* Size of the header, and alignment of the blocks */
+static int * tst_pool_offsets = NULL;
+static int tst_pool_offsets_num = 0;
+static int tst_pool_offset = 0;
+static char tst_pool_placement_string[32] = "default";
+static struct tst_pool_block * tst_pool_free_list[TST_POOL_CLASSES + 1];
+static size_t tst_pool_cached = 0;    /* Number of bytes in the free lists */
+static pthread_mutex_t tst_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long tst_pool_hits = 0;
+static unsigned long tst_pool_misses = 0;
+
+
+static int tst_pool_getclass (size_t size)
+{
+  int size_class = TST_POOL_MIN_CLASS;
+
+  if (size > TST_POOL_EXACT_MIN)
+    return TST_POOL_EXACT;
+  while (((size_t) 1 << size_class) < size)
+    size_class++;
+  return size_class;
+}
+
+
+static size_t tst_pool_roundup (size_t size, size_t page_size)
+{
+  return ((size + page_size - 1) / page_size) * page_size;
+}
+
+
+#ifdef HAVE_SYS_MMAN_H
+static void * tst_pool_mmap (size_t map_size, int flags)
+{
+  void * ptr;
+
+  ptr = mmap (NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+  if (ptr == MAP_FAILED)
+    ERROR (errno, flags ? "mmap of huge pages failed, check /proc/sys/vm/nr_hugepages" : "mmap");
+  return ptr;
+}
+#endif
+
+
+#ifdef TST_POOL_HAVE_NUMA
+static void tst_pool_mbind (void * ptr, size_t map_size)
+{
+  unsigned long nodemask[TST_POOL_MAX_NODES / (8 * sizeof (unsigned long))];
+
+  memset (nodemask, 0, sizeof (nodemask));
+  if (tst_pool_placement == TST_POOL_PLACEMENT_NODE)
+    {
+      nodemask[tst_pool_node / (8 * sizeof (unsigned long))] |= 1UL << (tst_pool_node % (8 * sizeof (unsigned long)));
+      if (mbind (ptr, map_size, MPOL_BIND, nodemask, TST_POOL_MAX_NODES, 0) != 0)
+        ERROR (errno, "mbind");
+    }
+  else
+    {
+      if (get_mempolicy (NULL, nodemask, TST_POOL_MAX_NODES, NULL, MPOL_F_MEMS_ALLOWED) != 0)
+        ERROR (errno, "get_mempolicy");
+      if (mbind (ptr, map_size, MPOL_INTERLEAVE, nodemask, TST_POOL_MAX_NODES, 0) != 0)
+        ERROR (errno, "mbind");
+    }
+}
+#endif
+
+
+static struct tst_pool_block * tst_pool_block_alloc (size_t size)
+{
+  const size_t total = tst_pool_header + size;
+  size_t map_size = 0;
+  void * ptr = NULL;
+  void * raw = NULL;
+
+  switch (tst_pool_placement)
+    {
+    case TST_POOL_PLACEMENT_DEFAULT:
+      if (posix_memalign (&ptr, tst_pool_header, total) != 0)
+        ERROR (ENOMEM, "posix_memalign");
+      break;
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+    case TST_POOL_PLACEMENT_THP:
+      if (posix_memalign (&ptr, TST_POOL_2M, tst_pool_roundup (total, TST_POOL_2M)) != 0)
+        ERROR (ENOMEM, "posix_memalign");
+      if (madvise (ptr, tst_pool_roundup (total, TST_POOL_2M), MADV_HUGEPAGE) != 0)
+        ERROR (errno, "madvise");
+      break;
+#endif
+#if defined(HAVE_SYS_MMAN_H) && defined(MAP_HUGETLB)
+    case TST_POOL_PLACEMENT_HUGETLB_2M:
+      map_size = tst_pool_roundup (total, TST_POOL_2M);
+      ptr = tst_pool_mmap (map_size, MAP_HUGETLB | MAP_HUGE_2MB);
+      break;
+    case TST_POOL_PLACEMENT_HUGETLB_1G:
+      map_size = tst_pool_roundup (total, TST_POOL_1G);
+      ptr = tst_pool_mmap (map_size, MAP_HUGETLB | MAP_HUGE_1GB);
+      break;
+#endif
+#if defined(HAVE_SYS_MMAN_H) && defined(TST_POOL_HAVE_NUMA)
+    case TST_POOL_PLACEMENT_NODE:
+    case TST_POOL_PLACEMENT_INTERLEAVE:
+      map_size = tst_pool_roundup (total, sysconf (_SC_PAGESIZE));
+      ptr = tst_pool_mmap (map_size, 0);
+      tst_pool_mbind (ptr, map_size);
+      break;
+#endif
+    case TST_POOL_PLACEMENT_ALLOC_MEM:
+      MPI_CHECK (MPI_Alloc_mem ((MPI_Aint) (total + tst_pool_header), MPI_INFO_NULL, &raw));
+      ptr = (char *) raw + (tst_pool_header - (uintptr_t) raw % tst_pool_header) % tst_pool_header;
+      break;
+    default:
+      ERROR (ENOTSUP, "Buffer placement not supported on this platform");
+    }
+
+  /*
+   * Only the header is written here: the pages of the buffer are faulted in
+   * under the policy of the block when tst_type_allocvalues initializes it.
+   */
+  memset (ptr, 0, sizeof (struct tst_pool_block));
+  ((struct tst_pool_block *) ptr)->size = size;
+  ((struct tst_pool_block *) ptr)->map_size = map_size;
+  ((struct tst_pool_block *) ptr)->raw = raw;
+  ((struct tst_pool_block *) ptr)->placement = tst_pool_placement;
+  return ptr;
+}
+
+
+static void tst_pool_block_free (struct tst_pool_block * block)
+{
+  if (block->placement == TST_POOL_PLACEMENT_ALLOC_MEM)
+    MPI_CHECK (MPI_Free_mem (block->raw));
+#ifdef HAVE_SYS_MMAN_H
+  else if (block->map_size > 0)
+    munmap (block, block->map_size);
+#endif
+  else
+    free (block);
+}
+
+
+static void tst_pool_parse (const char * placement)
+{
+  char * end;
+
+  if (placement == NULL || !strcasecmp (placement, "default"))
+    tst_pool_placement = TST_POOL_PLACEMENT_DEFAULT;
+  else if (!strcasecmp (placement, "thp"))
+    tst_pool_placement = TST_POOL_PLACEMENT_THP;
+  else if (!strcasecmp (placement, "hugetlb-2M"))
+    tst_pool_placement = TST_POOL_PLACEMENT_HUGETLB_2M;
+  else if (!strcasecmp (placement, "hugetlb-1G"))
+    tst_pool_placement = TST_POOL_PLACEMENT_HUGETLB_1G;
+  else if (!strncasecmp (placement, "node:", 5))
+    {
+      tst_pool_placement = TST_POOL_PLACEMENT_NODE;
+      tst_pool_node = strtol (placement + 5, &end, 10);
+      if (end == placement + 5 || *end != '\0' || tst_pool_node < 0 || tst_pool_node >= TST_POOL_MAX_NODES)
+        ERROR (EINVAL, "NUMA node has to be given as node:N");
+    }
+  else if (!strcasecmp (placement, "interleave"))
+    tst_pool_placement = TST_POOL_PLACEMENT_INTERLEAVE;
+  else if (!strcasecmp (placement, "alloc-mem"))
+    tst_pool_placement = TST_POOL_PLACEMENT_ALLOC_MEM;
+  else
+    ERROR (EINVAL, "Unknown buffer placement");
+
+  snprintf (tst_pool_placement_string, sizeof (tst_pool_placement_string), "%s",
+            placement == NULL ? "default" : placement);
+}
+
+
+static void tst_pool_parse_offsets (const char * offsets)
+{
+  char * list;
+  char * entry;
+  char * end;
+
+  if ((list = strdup (offsets == NULL ? "0" : offsets)) == NULL)
+    ERROR (errno, "strdup");
+
+  tst_pool_offsets_num = 0;
+  for (entry = strtok (list, ","); entry != NULL; entry = strtok (NULL, ","))
+    {
+      tst_pool_offsets = realloc (tst_pool_offsets, (tst_pool_offsets_num + 1) * sizeof (int));
+      if (tst_pool_offsets == NULL)
+        ERROR (errno, "realloc");
+      tst_pool_offsets[tst_pool_offsets_num] = strtol (entry, &end, 10);
+      if (end == entry || *end != '\0' || tst_pool_offsets[tst_pool_offsets_num] < 0)
+        ERROR (EINVAL, "Buffer offsets have to be comma-separated non-negative numbers of bytes");
+      tst_pool_offsets_num++;
+    }
+  free (list);
+  if (tst_pool_offsets_num == 0)
+    ERROR (EINVAL, "No buffer offset given");
+}
+
+
+int tst_pool_init (int mode, const char * placement, const char * offsets)
+{
+  if (mode != TST_POOL_OFF && mode != TST_POOL_ON)
+    ERROR (EINVAL, "Unknown buffer pool mode");
+
+  tst_pool_cleanup ();
+  tst_pool_mode = mode;
+  tst_pool_parse (placement);
+  tst_pool_parse_offsets (offsets);
+
+  /*
+   * Offsets are relative to the start of a page, the buffer without offset being page-aligned.
+   */
+  if (tst_pool_offsets_num > 1 || tst_pool_offsets[0] != 0)
+    tst_pool_header = sysconf (_SC_PAGESIZE);
+  tst_pool_offset = 0;
+  return 0;
+}
+
+
+int tst_pool_cleanup (void)
+{
+  struct tst_pool_block * block;
+  unsigned int i;
+
+  pthread_mutex_lock (&tst_pool_mutex);
+  for (i = 0; i <= TST_POOL_EXACT; i++)
+    while ((block = tst_pool_free_list[i]) != NULL)
+      {
+        tst_pool_free_list[i] = block->next;
+        tst_pool_block_free (block);
+      }
+  if (tst_pool_hits + tst_pool_misses > 0)
+    tst_output_printf (DEBUG_LOG, TST_REPORT_FULL, "(Rank:%d) Buffer pool: %lu reused, %lu new buffers\n",
+                       tst_global_rank, tst_pool_hits, tst_pool_misses);
+  tst_pool_cached = 0;
+  tst_pool_hits = 0;
+  tst_pool_misses = 0;
+  pthread_mutex_unlock (&tst_pool_mutex);
+
+  free (tst_pool_offsets);
+  tst_pool_offsets = NULL;
+  tst_pool_offsets_num = 0;
+  return 0;
+}
+
+
+const char * tst_pool_getplacement (void)
+{
+  return tst_pool_placement_string;
+}
+
+
+int tst_pool_getoffsets_num (void)
+{
+  return tst_pool_offsets_num;
+}
+
+
+int tst_pool_getoffset (int index)
+{
+  if (index < 0 || index >= tst_pool_offsets_num)
+    ERROR (EINVAL, "Index of buffer offset out of range");
+  return tst_pool_offsets[index];
+}
+
+
+int tst_pool_setoffset (int offset)
+{
+  if (offset < 0)
+    ERROR (EINVAL, "Buffer offset must not be negative");
+  tst_pool_offset = offset;
+  return 0;
+}
+
+
+static void * tst_pool_getbuffer (struct tst_pool_block * block)
+{
+  const size_t offset = tst_pool_offset;
+  char * ptr = (char *) block + tst_pool_header + offset;
+
+  memcpy (ptr - sizeof (size_t), &offset, sizeof (size_t));
+  return ptr;
+}
+
+
+static struct tst_pool_block * tst_pool_getblock (void * ptr)
+{
+  size_t offset;
+
+  memcpy (&offset, (char *) ptr - sizeof (size_t), sizeof (size_t));
+  return (struct tst_pool_block *) ((char *) ptr - offset - tst_pool_header);
+}
+
+
+void * tst_pool_alloc (size_t size)
+{
+  struct tst_pool_block * block;
+  struct tst_pool_block ** prev;
+  int size_class;
+
+  size += tst_pool_offset;
+  if (tst_pool_mode == TST_POOL_OFF)
+    {
+      block = tst_pool_block_alloc (size);
+      block->size_class = -1;
+      return tst_pool_getbuffer (block);
+    }
+
+  size_class = tst_pool_getclass (size);
+  if (size_class == TST_POOL_EXACT)
+    size = tst_pool_roundup (size, sysconf (_SC_PAGESIZE));
+  else
+    size = (size_t) 1 << size_class;
+
+  pthread_mutex_lock (&tst_pool_mutex);
+  prev = &tst_pool_free_list[size_class];
+  while ((block = *prev) != NULL && block->size != size)
+    prev = &block->next;
+  if (block != NULL)
+    {
+      *prev = block->next;
+      tst_pool_cached -= block->size;
+      tst_pool_hits++;
+    }
+  else
+    tst_pool_misses++;
+  pthread_mutex_unlock (&tst_pool_mutex);
+
+  if (block == NULL)
+    {
+      block = tst_pool_block_alloc (size);
+      block->size_class = size_class;
+    }
+  block->next = NULL;
+  return tst_pool_getbuffer (block);
+}
+
+
+void tst_pool_free (void * ptr)
+{
+  struct tst_pool_block * block;
+
+  if (ptr == NULL)
+    return;
+
+  block = tst_pool_getblock (ptr);
+  if (block->size_class < 0)
+    {
+      tst_pool_block_free (block);
+      return;
+    }
+
+  /*
+   * Blocks exceeding the budget of the free lists are released right away.
+   */
+  pthread_mutex_lock (&tst_pool_mutex);
+  if (tst_pool_cached + block->size <= TST_POOL_BUDGET)
+    {
+      block->next = tst_pool_free_list[block->size_class];
+      tst_pool_free_list[block->size_class] = block;
+      tst_pool_cached += block->size;
+      block = NULL;
+    }
+  pthread_mutex_unlock (&tst_pool_mutex);
+
+  if (block != NULL)
+    tst_pool_block_free (block);
+}
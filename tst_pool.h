@@ -0,0 +1,86 @@
+#ifndef TST_POOL_H_
+#define TST_POOL_H_
+
+#include <stddef.h>
+
+#include "mpi_test_suite.h"
+
+
+#define TST_POOL_OFF         0   /* Fresh buffers for every allocation */
+#define TST_POOL_ON          1   /* Recycled buffers */
+
+#define TST_POOL_PLACEMENT_DEFAULT     0   /* posix_memalign */
+#define TST_POOL_PLACEMENT_THP         1   /* Transparent huge pages */
+#define TST_POOL_PLACEMENT_HUGETLB_2M  2   /* Explicit 2 MB huge pages */
+#define TST_POOL_PLACEMENT_HUGETLB_1G  3   /* Explicit 1 GB huge pages */
+#define TST_POOL_PLACEMENT_NODE        4   /* Bound to one NUMA node */
+#define TST_POOL_PLACEMENT_INTERLEAVE  5   /* Interleaved over all allowed NUMA nodes */
+#define TST_POOL_PLACEMENT_ALLOC_MEM   6   /* MPI_Alloc_mem */
+
+/** \brief Select how buffers are allocated
+ *
+ * Buffers up to 1 MB are kept in power-of-two size classes, larger ones
+ * by their size rounded up to whole pages; a released buffer is reused by
+ * the next allocation of its size, even by another test. At most 256 MB
+ * are kept for reuse, further released buffers are freed. New buffers are
+ * aligned to 64 bytes.
+ *
+ * The placement is one of "default", "thp", "hugetlb-2M", "hugetlb-1G",
+ * "node:N", "interleave" and "alloc-mem".
+ *
+ * The offsets are a comma-separated list of numbers of bytes, by which
+ * buffers are shifted off their alignment, see tst_pool_setoffset.
+ * Unless only the offset 0 is given, buffers are page-aligned before
+ * applying the offset.
+ *
+ * \param[in] mode       TST_POOL_OFF or TST_POOL_ON
+ * \param[in] placement  placement policy of new buffers
+ * \param[in] offsets    list of buffer offsets to be swept
+ *
+ * \return 0 on success
+ */
+int tst_pool_init (int mode, const char * placement, const char * offsets);
+
+/** \brief Release all cached buffers, has to be called before MPI_Finalize */
+int tst_pool_cleanup (void);
+
+/** \brief Get the description of the placement policy of the buffers
+ *
+ * \return placement policy as given to tst_pool_init
+ */
+const char * tst_pool_getplacement (void);
+
+/** \brief Get the number of buffer offsets to be swept */
+int tst_pool_getoffsets_num (void);
+
+/** \brief Get a buffer offset to be swept
+ *
+ * \param[in] index  index of the offset in the list given to tst_pool_init
+ *
+ * \return offset in bytes
+ */
+int tst_pool_getoffset (int index);
+
+/** \brief Set the offset of the buffers allocated from now on
+ *
+ * \param[in] offset  number of bytes the buffers are shifted off their alignment
+ *
+ * \return 0 on success
+ */
+int tst_pool_setoffset (int offset);
+
+/** \brief Allocate a buffer of at least size bytes
+ *
+ * \param[in] size  requested size in bytes
+ *
+ * \return the buffer, aligned to 64 bytes respectively the page size, plus the current offset
+ */
+void * tst_pool_alloc (size_t size);
+
+/** \brief Return a buffer allocated with tst_pool_alloc
+ *
+ * \param[in] ptr  buffer to be returned, may be NULL
+ */
+void tst_pool_free (void * ptr);
+
+#endif  /* TST_POOL_H_ */
@@ -38,7 +38,11 @@ static const char * const tst_test_class_strings [] =
     "One-sided",
     "Dynamic",
     "IO",
-    "Threaded"
+    "Threaded",
+    "Large-count",
+    "Datatype",
+    "Neighborhood",
+    "Communicator"
   };
 
 struct tst_test {
@@ -52,6 +56,7 @@ struct tst_test {
   int (*tst_init_func) (struct tst_env * env);
   int (*tst_run_func) (struct tst_env * env);
   int (*tst_cleanup_func) (struct tst_env * env);
+  int benchmark;        /* Whether to aggregate the times over the ranks, TST_BENCH_RANK if omitted */
 };
 
 static struct tst_test tst_tests[] = {
@@ -1397,6 +1402,338 @@ static struct tst_test tst_tests[] = {
 
 #endif
 
+  /*
+   * Here come the large-count tests
+   */
+  {TST_CLASS_LARGE_COUNT, "Large-count ring",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_STANDARD_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_SYNC,
+   &tst_large_count_ring_init, &tst_large_count_ring_run, &tst_large_count_ring_cleanup},
+
+
+  {TST_CLASS_LARGE_COUNT, "Large-count alltoall",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_STANDARD_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,            /* No synchronization needed */
+   &tst_large_count_alltoall_init, &tst_large_count_alltoall_run, &tst_large_count_alltoall_cleanup},
+
+
+  {TST_CLASS_LARGE_COUNT, "Large-count bcast",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_STANDARD_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,            /* No synchronization needed */
+   &tst_large_count_bcast_init, &tst_large_count_bcast_run, &tst_large_count_bcast_cleanup},
+
+
+  {TST_CLASS_LARGE_COUNT, "Large-count allreduce max",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_STANDARD_C_TYPES &
+#ifdef HAVE_MPI2
+#  ifdef HAVE_MPI_MPICH2
+   ~(TST_MPI_CHAR | TST_MPI_SIGNED_CHAR | TST_MPI_BYTE),
+#  else
+   ~(TST_MPI_CHAR | TST_MPI_BYTE),
+#  endif
+#else
+   ~(TST_MPI_CHAR | TST_MPI_SIGNED_CHAR | TST_MPI_UNSIGNED_CHAR | TST_MPI_BYTE),
+#endif
+   TST_MODE_RELAXED,
+   TST_NONE,            /* No synchronization needed */
+   &tst_large_count_allreduce_init, &tst_large_count_allreduce_run, &tst_large_count_allreduce_cleanup},
+
+
+  {TST_CLASS_LARGE_COUNT, "Large-count file write/read",
+   TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_STANDARD_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_SYNC,            /* Needs sync due to bcast of filename in init */
+   &tst_large_count_file_init, &tst_large_count_file_run, &tst_large_count_file_cleanup},
+
+
+  /*
+   * Here come the datatype tests, measuring the datatype engine in benchmark mode
+   */
+  {TST_CLASS_DATATYPE, "Pack throughput",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,            /* No synchronization needed */
+   &tst_datatype_pack_init, &tst_datatype_pack_run, &tst_datatype_pack_cleanup},
+
+
+  {TST_CLASS_DATATYPE, "Pack_external throughput",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   /*
+    * In external32 a long has 4 bytes, which does not hold the values of the standard arrays;
+    * generated datatypes may contain longs as well.
+    */
+   TST_MPI_ALL_C_TYPES &
+   ~(TST_MPI_LONG | TST_MPI_UNSIGNED_LONG | TST_MPI_LONG_INT | TST_MPI_TYPE_MIX | TST_MPI_TYPE_MIX_ARRAY |
+     TST_MPI_TYPE_GENERATED),
+   TST_MODE_RELAXED,
+   TST_NONE,            /* No synchronization needed */
+   &tst_datatype_pack_external_init, &tst_datatype_pack_external_run, &tst_datatype_pack_external_cleanup},
+
+
+  {TST_CLASS_DATATYPE, "Sendrecv throughput",
+   TST_MPI_COMM_SELF | TST_MPI_INTRA_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_datatype_sendrecv_init, &tst_datatype_sendrecv_run, &tst_datatype_sendrecv_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  /*
+   * Here come the neighborhood collective tests, compared to a halo exchange in benchmark mode
+   */
+#if MPI_VERSION >= 3
+  {TST_CLASS_NEIGHBOR, "Neighbor_allgather",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_allgather_init, &tst_neighbor_allgather_run, &tst_neighbor_allgather_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_NEIGHBOR, "Ineighbor_allgather",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_allgather_init, &tst_neighbor_iallgather_run, &tst_neighbor_allgather_cleanup,
+   TST_BENCH_AGGREGATE},
+
+#if MPI_VERSION >= 4
+  {TST_CLASS_NEIGHBOR, "Neighbor_allgather_init",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_allgather_persistent_init, &tst_neighbor_allgather_persistent_run, &tst_neighbor_allgather_persistent_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+
+
+  {TST_CLASS_NEIGHBOR, "Neighbor_alltoall",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoall_init, &tst_neighbor_alltoall_run, &tst_neighbor_alltoall_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_NEIGHBOR, "Ineighbor_alltoall",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoall_init, &tst_neighbor_ialltoall_run, &tst_neighbor_alltoall_cleanup,
+   TST_BENCH_AGGREGATE},
+
+#if MPI_VERSION >= 4
+  {TST_CLASS_NEIGHBOR, "Neighbor_alltoall_init",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoall_persistent_init, &tst_neighbor_alltoall_persistent_run, &tst_neighbor_alltoall_persistent_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+
+
+  {TST_CLASS_NEIGHBOR, "Neighbor_alltoallv",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoallv_init, &tst_neighbor_alltoallv_run, &tst_neighbor_alltoallv_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_NEIGHBOR, "Ineighbor_alltoallv",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoallv_init, &tst_neighbor_ialltoallv_run, &tst_neighbor_alltoallv_cleanup,
+   TST_BENCH_AGGREGATE},
+
+#if MPI_VERSION >= 4
+  {TST_CLASS_NEIGHBOR, "Neighbor_alltoallv_init",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoallv_persistent_init, &tst_neighbor_alltoallv_persistent_run, &tst_neighbor_alltoallv_persistent_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+
+
+  {TST_CLASS_NEIGHBOR, "Neighbor_alltoallw",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoallw_init, &tst_neighbor_alltoallw_run, &tst_neighbor_alltoallw_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_NEIGHBOR, "Ineighbor_alltoallw",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoallw_init, &tst_neighbor_ialltoallw_run, &tst_neighbor_alltoallw_cleanup,
+   TST_BENCH_AGGREGATE},
+
+#if MPI_VERSION >= 4
+  {TST_CLASS_NEIGHBOR, "Neighbor_alltoallw_init",
+   TST_MPI_CART_COMM | TST_MPI_TOPO_COMM,
+   1,
+   TST_MPI_ALL_C_TYPES,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_neighbor_alltoallw_persistent_init, &tst_neighbor_alltoallw_persistent_run, &tst_neighbor_alltoallw_persistent_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+#endif
+
+
+  /*
+   * Here come the communicator construction tests, swept over the communicator size in benchmark mode
+   */
+  {TST_CLASS_COMM, "Comm_dup",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_dup_init, &tst_comm_dup_run, &tst_comm_dup_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+#if MPI_VERSION >= 3
+  {TST_CLASS_COMM, "Comm_idup",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_dup_init, &tst_comm_idup_run, &tst_comm_dup_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+
+
+  {TST_CLASS_COMM, "Comm_split few colors",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_split_init, &tst_comm_split_few_run, &tst_comm_split_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_COMM, "Comm_split many colors",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_split_init, &tst_comm_split_many_run, &tst_comm_split_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+#if MPI_VERSION >= 3
+  {TST_CLASS_COMM, "Comm_split_type",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_split_init, &tst_comm_split_type_run, &tst_comm_split_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+
+
+  {TST_CLASS_COMM, "Comm_create",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_group_init, &tst_comm_create_run, &tst_comm_group_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+#if MPI_VERSION >= 3
+  {TST_CLASS_COMM, "Comm_create_group",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_group_init, &tst_comm_create_group_run, &tst_comm_group_cleanup,
+   TST_BENCH_AGGREGATE},
+#endif
+
+
+  {TST_CLASS_COMM, "Intercomm_create",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   2,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_intercomm_init, &tst_comm_intercomm_create_run, &tst_comm_intercomm_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_COMM, "Intercomm_merge",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   2,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_intercomm_merge_init, &tst_comm_intercomm_merge_run, &tst_comm_intercomm_merge_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
+  {TST_CLASS_COMM, "Cart_create reorder",
+   TST_MPI_INTRA_COMM | TST_MPI_CART_COMM,
+   1,
+   TST_MPI_CHAR,
+   TST_MODE_RELAXED,
+   TST_NONE,
+   &tst_comm_cart_create_init, &tst_comm_cart_create_run, &tst_comm_cart_create_cleanup,
+   TST_BENCH_AGGREGATE},
+
+
   {TST_CLASS_UNSPEC, "None",
    0,
    0,
@@ -1408,6 +1745,8 @@ static struct tst_test tst_tests[] = {
 
 static struct tst_env * tst_tests_failed = NULL;
 static int tst_tests_failed_num = 0;
+static int tst_tests_failed_suppress = 0;   /* Count failures without recording them */
+static int tst_tests_failure_events = 0;    /* Number of failures reported, recorded or not */
 
 
 int tst_test_init (int * num_tests)
@@ -1441,7 +1780,11 @@ const char *tst_test_getclass_string(int i) {
          tst_tests[i].class != TST_CLASS_ONE_SIDED &&
          tst_tests[i].class != TST_CLASS_DYNAMIC &&
          tst_tests[i].class != TST_CLASS_IO &&
-         tst_tests[i].class != TST_CLASS_THREADED)
+         tst_tests[i].class != TST_CLASS_THREADED &&
+         tst_tests[i].class != TST_CLASS_LARGE_COUNT &&
+         tst_tests[i].class != TST_CLASS_DATATYPE &&
+         tst_tests[i].class != TST_CLASS_NEIGHBOR &&
+         tst_tests[i].class != TST_CLASS_COMM)
        ERROR (EINVAL, "Class of test is unknown");
      );
   /*
@@ -1452,6 +1795,13 @@ const char *tst_test_getclass_string(int i) {
   return tst_test_class_strings[ffs (tst_tests[i].class)];
 }
 
+int tst_test_getclass (int i)
+{
+  CHECK_ARG (i, -1);
+
+  return tst_tests[i].class;
+}
+
 const char * tst_test_getdescription (int i)
 {
   CHECK_ARG (i, NULL);
@@ -1466,10 +1816,29 @@ int tst_test_getmode (int i)
   return tst_tests[i].mode;
 }
 
+/*
+ * Some communicators, e.g. the one of the node leaders, do not include all processes;
+ * the others still take part in the synchronization around the test, but skip the test itself.
+ */
+static int tst_test_skip_func (struct tst_env * env)
+{
+  (void) env;
+  return 0;
+}
+
+static int tst_test_skip (const struct tst_env * env)
+{
+  return tst_comm_getcommsize (env->comm) == 0 &&
+    !(tst_comm_getcommclass (env->comm) & TST_MPI_COMM_NULL);
+}
+
+
 int tst_test_init_func (struct tst_env * env)
 {
   CHECK_ARG (env->test, -1);
 
+  if (tst_test_skip (env))
+    return 0;
   return tst_tests[env->test].tst_init_func (env);
 }
 
@@ -1478,6 +1847,8 @@ int tst_test_run_func (struct tst_env * env)
 {
   CHECK_ARG (env->test, -1);
 
+  if (tst_test_skip (env))
+    return 0;
   return tst_tests[env->test].tst_run_func (env);
 }
 
@@ -1485,6 +1856,8 @@ int tst_test_cleanup_func (struct tst_env * env)
 {
   CHECK_ARG (env->test, -1);
 
+  if (tst_test_skip (env))
+    return 0;
   return tst_tests[env->test].tst_cleanup_func (env);
 }
 
@@ -1492,18 +1865,24 @@ int tst_test_cleanup_func (struct tst_env * env)
 void *  tst_test_get_init_func (struct tst_env * env)
 {
   CHECK_ARG (env->test, NULL);
+  if (tst_test_skip (env))
+    return tst_test_skip_func;
   return tst_tests[env->test].tst_init_func;
 }
 
 void * tst_test_get_run_func (struct tst_env * env)
 {
   CHECK_ARG (env->test, NULL);
+  if (tst_test_skip (env))
+    return tst_test_skip_func;
   return tst_tests[env->test].tst_run_func;
 }
 
 void * tst_test_get_cleanup_func (struct tst_env * env)
 {
   CHECK_ARG (env->test, NULL);
+  if (tst_test_skip (env))
+    return tst_test_skip_func;
   return tst_tests[env->test].tst_cleanup_func;
 }
 
@@ -1517,14 +1896,14 @@ int tst_test_check_run (struct tst_env * env)
       env->test > TST_TESTS_NUM ||
       tst_test_getmode (env->test) < tst_mode ||
       (tst_comm_getcommclass (env->comm) & tst_tests[env->test].run_with_comm) == (tst_uint64)0 ||
-      (tst_comm_getcommsize (env->comm) < tst_tests[env->test].min_comm_size) ||
+      (tst_comm_getminsize (env->comm) < tst_tests[env->test].min_comm_size) ||
       (tst_type_gettypeclass (env->type) & tst_tests[env->test].run_with_type) == (tst_uint64)0)
     {
       tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) env->comm:%d getcommclass:%d test is run_with_comm:%d "
                      "comm_size:%d min_comm_size:%d gettypeclass:%lld run_with_type:%d\n",
                      tst_global_rank, env->comm, tst_comm_getcommclass (env->comm),
                      tst_tests[env->test].run_with_comm,
-                     tst_comm_getcommsize(env->comm), tst_tests[env->test].min_comm_size,
+                     tst_comm_getminsize(env->comm), tst_tests[env->test].min_comm_size,
                      tst_type_gettypeclass (env->type), tst_tests[env->test].run_with_type);
       return 0;
     }
@@ -1538,6 +1917,12 @@ int tst_test_check_sync (struct tst_env * env)
   return tst_tests[env->test].needs_sync;
 }
 
+int tst_test_check_aggregate (struct tst_env * env)
+{
+  CHECK_ARG (env->test, -1);
+  return tst_tests[env->test].needs_sync || tst_tests[env->test].benchmark == TST_BENCH_AGGREGATE;
+}
+
 
 void tst_test_list (void)
 {
@@ -1712,6 +2097,11 @@ int tst_test_deselect(const char *test_string, int *test_list,
 int tst_test_recordfailure (const struct tst_env * env)
 {
   int i;
+
+  tst_tests_failure_events++;
+  if (tst_tests_failed_suppress)
+    return 0;
+
   /*
    * First make sure, that this combination is not already
    * in the failed-list
@@ -1720,7 +2110,9 @@ int tst_test_recordfailure (const struct tst_env * env)
     if (tst_tests_failed[i].comm == env->comm &&
         tst_tests_failed[i].type == env->type &&
         tst_tests_failed[i].test == env->test &&
-        tst_tests_failed[i].values_num == env->values_num)
+        tst_tests_failed[i].values_num == env->values_num &&
+        tst_tests_failed[i].values_count == env->values_count &&
+        tst_tests_failed[i].buffer_offset == env->buffer_offset)
       break;
   if (i == tst_tests_failed_num)
     {
@@ -1734,6 +2126,8 @@ int tst_test_recordfailure (const struct tst_env * env)
       tst_tests_failed[tst_tests_failed_num].type = env->type;
       tst_tests_failed[tst_tests_failed_num].test = env->test;
       tst_tests_failed[tst_tests_failed_num].values_num= env->values_num;
+      tst_tests_failed[tst_tests_failed_num].values_count = env->values_count;
+      tst_tests_failed[tst_tests_failed_num].buffer_offset = env->buffer_offset;
       tst_tests_failed_num++;
 
       if (tst_tests_failed_num == TST_TESTS_NUM_FAILED_MAX)
@@ -1747,6 +2141,17 @@ int tst_test_get_failed_num (void)
   return tst_tests_failed_num;
 }
 
+int tst_test_suppress_failures (int suppress)
+{
+  tst_tests_failed_suppress = suppress;
+  return 0;
+}
+
+int tst_test_get_failure_events (void)
+{
+  return tst_tests_failure_events;
+}
+
 int tst_test_print_failed (void)
 {
   int i;
@@ -1757,13 +2162,14 @@ int tst_test_print_failed (void)
         const int test = tst_tests_failed[i].test;
         const int comm = tst_tests_failed[i].comm;
         const int type = tst_tests_failed[i].type;
-        const int values_num= tst_tests_failed[i].values_num;
+        const tst_count values_count = tst_tests_failed[i].values_count;
+        const int buffer_offset = tst_tests_failed[i].buffer_offset;
 
-        printf ("ERROR class:%s test:%s (%d), comm %s (%d), type %s (%d) number of values:%d\n",
+        printf ("ERROR class:%s test:%s (%d), comm %s (%d), type %s (%d) number of values:%lld buffer offset:%d\n",
                 tst_test_getclass_string (test),
                 tst_test_getdescription (test), test+1,
                 tst_comm_getdescription (comm), comm+1,
-                tst_type_getdescription (type), type+1, values_num);
+                tst_type_getdescription (type), type+1, (long long) values_count, buffer_offset);
       }
   }
   return 0;
@@ -1778,6 +2184,15 @@ int tst_test_checkstandardarray (const struct tst_env * env, char * buffer, int
   return ret;
 }
 
+int tst_test_checkstandardarray_count (const struct tst_env * env, char * buffer, int comm_rank)
+{
+  int ret;
+  ret = tst_type_checkstandardarray_count (env->type, env->values_count, buffer, comm_rank);
+  if (0 != ret)
+    tst_test_recordfailure (env);
+  return ret;
+}
+
 int tst_test_is_empty_status (MPI_Status * status)
 {
     if (status->MPI_SOURCE == MPI_ANY_SOURCE &&
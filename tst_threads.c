@@ -336,6 +336,12 @@ inline int tst_thread_num_threads () {
 }
 
 
+pthread_t tst_thread_get_tid (int thread_num) {
+  assert(thread_num >= 0 && thread_num < num_threads);
+  return tst_thread_tid_array[thread_num];
+}
+
+
 inline int tst_thread_running () {
   return (num_threads > 0);
 }
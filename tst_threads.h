@@ -54,6 +54,7 @@ int tst_thread_execute_cleanup(struct tst_env *env);
 int tst_thread_get_num();
 int tst_thread_running();
 int tst_thread_num_threads();
+pthread_t tst_thread_get_tid(int thread_num);
 
 int tst_thread_signal_init(int num);
 int tst_thread_signal_cleanup();
@@ -0,0 +1,663 @@
+#include "config.h"
+
+#include "tst_typegen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <limits.h>
+#include <ctype.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+
+
+#define TST_TYPEGEN_DEPTH_MAX   64           /* Nesting depth of constructors */
+#define TST_TYPEGEN_LEAVES_MAX  (1 << 24)    /* Basic elements of one datatype */
+#define TST_TYPEGEN_LINE_MAX    4096
+
+struct tst_typegen_base {
+  const char * name;
+  MPI_Datatype type;
+};
+
+static const struct tst_typegen_base tst_typegen_bases[] = {
+  {"char", MPI_CHAR},
+  {"uchar", MPI_UNSIGNED_CHAR},
+#ifdef HAVE_MPI2
+  {"schar", MPI_SIGNED_CHAR},
+#endif
+  {"byte", MPI_BYTE},
+  {"short", MPI_SHORT},
+  {"ushort", MPI_UNSIGNED_SHORT},
+  {"int", MPI_INT},
+  {"uint", MPI_UNSIGNED},
+  {"long", MPI_LONG},
+  {"ulong", MPI_UNSIGNED_LONG},
+#if defined(HAVE_C_MPI_LONG_LONG_INT)
+  {"llong", MPI_LONG_LONG},
+#endif
+  {"float", MPI_FLOAT},
+  {"double", MPI_DOUBLE}
+};
+
+#define TST_TYPEGEN_BASES_NUM (sizeof (tst_typegen_bases) / sizeof (tst_typegen_bases[0]))
+
+static const char * const tst_typegen_constructors[] = {
+  "contig", "vector", "hvector", "indexed", "hindexed", "struct", "subarray", "resized"
+};
+
+#define TST_TYPEGEN_CONSTRUCTORS_NUM (sizeof (tst_typegen_constructors) / sizeof (tst_typegen_constructors[0]))
+
+struct tst_typegen_parser {
+  const char * spec;           /* Whole spec, for error messages */
+  const char * pos;
+};
+
+/*
+ * A (sub-)datatype while parsing, with its basic elements relative to its origin.
+ */
+struct tst_typegen_node {
+  MPI_Datatype type;
+  int derived;                 /* Whether type has to be freed */
+  MPI_Aint extent;
+  int leaves_num;
+  int leaves_max;
+  MPI_Aint * disps;
+  MPI_Datatype * bases;
+};
+
+struct tst_typegen_extent {
+  MPI_Aint disp;
+  int size;
+};
+
+static struct tst_typegen_type * tst_typegen_types = NULL;
+static int tst_typegen_types_num = 0;
+static int tst_typegen_types_max = 0;
+
+
+static void tst_typegen_error (const struct tst_typegen_parser * p, const char * msg)
+{
+  char buffer[256];
+  snprintf (buffer, sizeof (buffer), "Datatype spec \"%.128s\": %s at position %d",
+            p->spec, msg, (int) (p->pos - p->spec));
+  ERROR (EINVAL, buffer);
+}
+
+
+static void tst_typegen_skip (struct tst_typegen_parser * p)
+{
+  while (isspace ((unsigned char) *p->pos))
+    p->pos++;
+}
+
+
+static int tst_typegen_accept (struct tst_typegen_parser * p, char c)
+{
+  tst_typegen_skip (p);
+  if (*p->pos != c)
+    return 0;
+  p->pos++;
+  return 1;
+}
+
+
+static void tst_typegen_expect (struct tst_typegen_parser * p, char c)
+{
+  char msg[32];
+  if (!tst_typegen_accept (p, c))
+    {
+      snprintf (msg, sizeof (msg), "expected '%c'", c);
+      tst_typegen_error (p, msg);
+    }
+}
+
+
+/*
+ * Parse a possibly negative number with the optional suffixes K, M or G (powers of 1024).
+ */
+static long long tst_typegen_number (struct tst_typegen_parser * p)
+{
+  long long num;
+  long long mult = 1;
+  char * end;
+
+  tst_typegen_skip (p);
+  errno = 0;
+  num = strtoll (p->pos, &end, 10);
+  if (end == p->pos || errno == ERANGE)
+    tst_typegen_error (p, "expected a number");
+  p->pos = end;
+  switch (toupper ((unsigned char) *p->pos))
+    {
+      case 'K': mult = 1LL << 10; p->pos++; break;
+      case 'M': mult = 1LL << 20; p->pos++; break;
+      case 'G': mult = 1LL << 30; p->pos++; break;
+    }
+  if (num > LLONG_MAX / mult || num < LLONG_MIN / mult)
+    tst_typegen_error (p, "number too large");
+  return num * mult;
+}
+
+
+static int tst_typegen_int (struct tst_typegen_parser * p, int min)
+{
+  const long long num = tst_typegen_number (p);
+  if (num < min || num > INT_MAX)
+    tst_typegen_error (p, "number out of range");
+  return (int) num;
+}
+
+
+/*
+ * Parse a list [a, b, ...] of non-negative ints.
+ */
+static int tst_typegen_list (struct tst_typegen_parser * p, int ** vals)
+{
+  int num = 0;
+
+  *vals = NULL;
+  tst_typegen_expect (p, '[');
+  do
+    {
+      if ((*vals = realloc (*vals, (num + 1) * sizeof (int))) == NULL)
+        ERROR (errno, "realloc");
+      (*vals)[num++] = tst_typegen_int (p, 0);
+    }
+  while (tst_typegen_accept (p, ','));
+  tst_typegen_expect (p, ']');
+  return num;
+}
+
+
+/*
+ * Parse a list [blocklen:disp, ...] of blocks.
+ */
+static int tst_typegen_blocks (struct tst_typegen_parser * p, int ** lens, MPI_Aint ** disps)
+{
+  int num = 0;
+
+  *lens = NULL;
+  *disps = NULL;
+  tst_typegen_expect (p, '[');
+  do
+    {
+      if ((*lens = realloc (*lens, (num + 1) * sizeof (int))) == NULL ||
+          (*disps = realloc (*disps, (num + 1) * sizeof (MPI_Aint))) == NULL)
+        ERROR (errno, "realloc");
+      (*lens)[num] = tst_typegen_int (p, 0);
+      tst_typegen_expect (p, ':');
+      (*disps)[num] = (MPI_Aint) tst_typegen_number (p);
+      num++;
+    }
+  while (tst_typegen_accept (p, ','));
+  tst_typegen_expect (p, ']');
+  return num;
+}
+
+
+static void tst_typegen_addleaf (struct tst_typegen_node * node, MPI_Aint disp, MPI_Datatype base)
+{
+  if (node->leaves_num == node->leaves_max)
+    {
+      if (node->leaves_max >= TST_TYPEGEN_LEAVES_MAX)
+        ERROR (EINVAL, "Generated datatype has too many basic elements");
+      node->leaves_max = (node->leaves_max == 0) ? 16 : 2 * node->leaves_max;
+      node->disps = realloc (node->disps, node->leaves_max * sizeof (MPI_Aint));
+      node->bases = realloc (node->bases, node->leaves_max * sizeof (MPI_Datatype));
+      if (node->disps == NULL || node->bases == NULL)
+        ERROR (errno, "realloc");
+    }
+  node->disps[node->leaves_num] = disp;
+  node->bases[node->leaves_num] = base;
+  node->leaves_num++;
+}
+
+
+static void tst_typegen_addleaves (struct tst_typegen_node * node, const struct tst_typegen_node * child, MPI_Aint disp)
+{
+  int i;
+  for (i = 0; i < child->leaves_num; i++)
+    tst_typegen_addleaf (node, disp + child->disps[i], child->bases[i]);
+}
+
+
+static void tst_typegen_freenode (struct tst_typegen_node * node)
+{
+  if (node->derived)
+    MPI_CHECK (MPI_Type_free (&node->type));
+  free (node->disps);
+  free (node->bases);
+  memset (node, 0, sizeof (struct tst_typegen_node));
+}
+
+
+static void tst_typegen_type (struct tst_typegen_parser * p, struct tst_typegen_node * node, int depth)
+{
+  struct tst_typegen_node child;
+  char word[16];
+  size_t len = 0;
+  MPI_Aint lb;
+  int i, j;
+
+  memset (node, 0, sizeof (struct tst_typegen_node));
+  if (depth > TST_TYPEGEN_DEPTH_MAX)
+    tst_typegen_error (p, "datatype nested too deeply");
+
+  tst_typegen_skip (p);
+  while (isalnum ((unsigned char) *p->pos) || *p->pos == '_')
+    {
+      if (len == sizeof (word) - 1)
+        tst_typegen_error (p, "unknown datatype");
+      word[len++] = tolower ((unsigned char) *p->pos++);
+    }
+  word[len] = '\0';
+  if (len == 0)
+    tst_typegen_error (p, "expected a datatype");
+
+  for (i = 0; i < (int) TST_TYPEGEN_BASES_NUM; i++)
+    if (!strcmp (word, tst_typegen_bases[i].name))
+      {
+        node->type = tst_typegen_bases[i].type;
+        MPI_CHECK (MPI_Type_get_extent (node->type, &lb, &node->extent));
+        tst_typegen_addleaf (node, 0, node->type);
+        return;
+      }
+
+  for (i = 0; i < (int) TST_TYPEGEN_CONSTRUCTORS_NUM; i++)
+    if (!strcmp (word, tst_typegen_constructors[i]))
+      break;
+  if (i == (int) TST_TYPEGEN_CONSTRUCTORS_NUM)
+    tst_typegen_error (p, "unknown datatype");
+  tst_typegen_expect (p, '(');
+
+  if (!strcmp (word, "contig"))
+    {
+      const int count = tst_typegen_int (p, 0);
+      tst_typegen_expect (p, ',');
+      tst_typegen_type (p, &child, depth + 1);
+      MPI_CHECK (MPI_Type_contiguous (count, child.type, &node->type));
+      for (i = 0; i < count; i++)
+        tst_typegen_addleaves (node, &child, i * child.extent);
+      tst_typegen_freenode (&child);
+    }
+  else if (!strcmp (word, "vector") || !strcmp (word, "hvector"))
+    {
+      const int hvector = (word[0] == 'h');
+      int count, blocklen;
+      MPI_Aint stride;
+
+      count = tst_typegen_int (p, 0);
+      tst_typegen_expect (p, ',');
+      blocklen = tst_typegen_int (p, 0);
+      tst_typegen_expect (p, ',');
+      stride = hvector ? (MPI_Aint) tst_typegen_number (p) : tst_typegen_int (p, INT_MIN);
+      tst_typegen_expect (p, ',');
+      tst_typegen_type (p, &child, depth + 1);
+      if (hvector)
+        MPI_CHECK (MPI_Type_create_hvector (count, blocklen, stride, child.type, &node->type));
+      else
+        {
+          MPI_CHECK (MPI_Type_vector (count, blocklen, (int) stride, child.type, &node->type));
+          stride *= child.extent;
+        }
+      for (i = 0; i < count; i++)
+        for (j = 0; j < blocklen; j++)
+          tst_typegen_addleaves (node, &child, i * stride + j * child.extent);
+      tst_typegen_freenode (&child);
+    }
+  else if (!strcmp (word, "indexed") || !strcmp (word, "hindexed"))
+    {
+      const int hindexed = (word[0] == 'h');
+      int * lens;
+      int * int_disps;
+      MPI_Aint * disps;
+      int num;
+
+      num = tst_typegen_blocks (p, &lens, &disps);
+      tst_typegen_expect (p, ',');
+      tst_typegen_type (p, &child, depth + 1);
+      if (hindexed)
+        MPI_CHECK (MPI_Type_create_hindexed (num, lens, disps, child.type, &node->type));
+      else
+        {
+          if ((int_disps = malloc (num * sizeof (int))) == NULL)
+            ERROR (errno, "malloc");
+          for (i = 0; i < num; i++)
+            {
+              if (disps[i] < INT_MIN || disps[i] > INT_MAX)
+                tst_typegen_error (p, "displacement out of range");
+              int_disps[i] = (int) disps[i];
+              disps[i] *= child.extent;
+            }
+          MPI_CHECK (MPI_Type_indexed (num, lens, int_disps, child.type, &node->type));
+          free (int_disps);
+        }
+      for (i = 0; i < num; i++)
+        for (j = 0; j < lens[i]; j++)
+          tst_typegen_addleaves (node, &child, disps[i] + j * child.extent);
+      tst_typegen_freenode (&child);
+      free (lens);
+      free (disps);
+    }
+  else if (!strcmp (word, "struct"))
+    {
+      struct tst_typegen_node * fields = NULL;
+      MPI_Datatype * field_types;
+      MPI_Aint * disps = NULL;
+      int * lens = NULL;
+      int num = 0;
+
+      do
+        {
+          if ((fields = realloc (fields, (num + 1) * sizeof (struct tst_typegen_node))) == NULL ||
+              (lens = realloc (lens, (num + 1) * sizeof (int))) == NULL ||
+              (disps = realloc (disps, (num + 1) * sizeof (MPI_Aint))) == NULL)
+            ERROR (errno, "realloc");
+          tst_typegen_skip (p);
+          lens[num] = 1;
+          if (isdigit ((unsigned char) *p->pos))
+            {
+              lens[num] = tst_typegen_int (p, 0);
+              tst_typegen_expect (p, '*');
+            }
+          tst_typegen_type (p, &fields[num], depth + 1);
+          tst_typegen_expect (p, '@');
+          disps[num] = (MPI_Aint) tst_typegen_number (p);
+          num++;
+        }
+      while (tst_typegen_accept (p, ','));
+
+      if ((field_types = malloc (num * sizeof (MPI_Datatype))) == NULL)
+        ERROR (errno, "malloc");
+      for (i = 0; i < num; i++)
+        field_types[i] = fields[i].type;
+      MPI_CHECK (MPI_Type_create_struct (num, lens, disps, field_types, &node->type));
+      for (i = 0; i < num; i++)
+        {
+          for (j = 0; j < lens[i]; j++)
+            tst_typegen_addleaves (node, &fields[i], disps[i] + j * fields[i].extent);
+          tst_typegen_freenode (&fields[i]);
+        }
+      free (field_types);
+      free (fields);
+      free (lens);
+      free (disps);
+    }
+  else if (!strcmp (word, "subarray"))
+    {
+      int * sizes;
+      int * subsizes;
+      int * starts;
+      int * idx;
+      int ndims;
+      MPI_Aint offset;
+
+      ndims = tst_typegen_list (p, &sizes);
+      tst_typegen_expect (p, ',');
+      if (tst_typegen_list (p, &subsizes) != ndims)
+        tst_typegen_error (p, "subsizes do not match the dimensions of sizes");
+      tst_typegen_expect (p, ',');
+      if (tst_typegen_list (p, &starts) != ndims)
+        tst_typegen_error (p, "starts do not match the dimensions of sizes");
+      for (i = 0; i < ndims; i++)
+        if (sizes[i] < 1 || subsizes[i] < 1 || starts[i] + (long long) subsizes[i] > sizes[i])
+          tst_typegen_error (p, "subarray exceeds the array");
+      tst_typegen_expect (p, ',');
+      tst_typegen_type (p, &child, depth + 1);
+      MPI_CHECK (MPI_Type_create_subarray (ndims, sizes, subsizes, starts, MPI_ORDER_C,
+                                           child.type, &node->type));
+
+      /*
+       * Walk the subarray in C order, the last dimension running fastest.
+       */
+      if ((idx = calloc (ndims, sizeof (int))) == NULL)
+        ERROR (errno, "calloc");
+      do
+        {
+          offset = 0;
+          for (i = 0; i < ndims; i++)
+            offset = offset * sizes[i] + starts[i] + idx[i];
+          tst_typegen_addleaves (node, &child, offset * child.extent);
+          for (i = ndims - 1; i >= 0 && ++idx[i] == subsizes[i]; i--)
+            idx[i] = 0;
+        }
+      while (i >= 0);
+      tst_typegen_freenode (&child);
+      free (idx);
+      free (sizes);
+      free (subsizes);
+      free (starts);
+    }
+  else /* resized */
+    {
+      MPI_Aint new_lb, new_extent;
+
+      new_lb = (MPI_Aint) tst_typegen_number (p);
+      tst_typegen_expect (p, ',');
+      new_extent = (MPI_Aint) tst_typegen_number (p);
+      tst_typegen_expect (p, ',');
+      tst_typegen_type (p, &child, depth + 1);
+      MPI_CHECK (MPI_Type_create_resized (child.type, new_lb, new_extent, &node->type));
+      tst_typegen_addleaves (node, &child, 0);
+      tst_typegen_freenode (&child);
+    }
+  tst_typegen_expect (p, ')');
+
+  node->derived = 1;
+  MPI_CHECK (MPI_Type_get_extent (node->type, &lb, &node->extent));
+}
+
+
+static int tst_typegen_cmp_extent (const void * a, const void * b)
+{
+  const MPI_Aint da = ((const struct tst_typegen_extent *) a)->disp;
+  const MPI_Aint db = ((const struct tst_typegen_extent *) b)->disp;
+  return (da > db) - (da < db);
+}
+
+
+/*
+ * Check that the basic elements neither overlap nor stick out of [0, extent).
+ */
+static void tst_typegen_check (const struct tst_typegen_parser * p, const struct tst_typegen_node * node)
+{
+  struct tst_typegen_extent * extents;
+  int i;
+
+  if ((extents = malloc (node->leaves_num * sizeof (struct tst_typegen_extent))) == NULL)
+    ERROR (errno, "malloc");
+  for (i = 0; i < node->leaves_num; i++)
+    {
+      extents[i].disp = node->disps[i];
+      MPI_CHECK (MPI_Type_size (node->bases[i], &extents[i].size));
+    }
+  qsort (extents, node->leaves_num, sizeof (struct tst_typegen_extent), tst_typegen_cmp_extent);
+
+  for (i = 0; i < node->leaves_num; i++)
+    {
+      if (extents[i].disp < 0 || extents[i].disp + extents[i].size > node->extent)
+        tst_typegen_error (p, "data lies outside of the extent");
+      if (i > 0 && extents[i - 1].disp + extents[i - 1].size > extents[i].disp)
+        tst_typegen_error (p, "data overlaps");
+    }
+  free (extents);
+}
+
+
+static void tst_typegen_add (const char * item)
+{
+  struct tst_typegen_parser p;
+  struct tst_typegen_node node;
+  struct tst_typegen_type * gen;
+  const char * eq = strchr (item, '=');
+  const char * paren = strchr (item, '(');
+  char name[TST_DESCRIPTION_LEN];
+  MPI_Aint lb;
+  int i;
+
+  p.spec = item;
+  p.pos = item;
+  if (eq != NULL && (paren == NULL || eq < paren))
+    {
+      const char * end = eq;
+      while (end > item && isspace ((unsigned char) end[-1]))
+        end--;
+      if (end == item || end - item >= TST_DESCRIPTION_LEN)
+        tst_typegen_error (&p, "invalid name of datatype");
+      for (; p.pos < end; p.pos++)
+        if (!isalnum ((unsigned char) *p.pos) && strchr ("_-.", *p.pos) == NULL)
+          tst_typegen_error (&p, "invalid character in name of datatype");
+      memcpy (name, item, end - item);
+      name[end - item] = '\0';
+      p.pos = eq + 1;
+    }
+  else
+    snprintf (name, sizeof (name), "GENERATED_%d", tst_typegen_types_num);
+
+  for (i = 0; i < tst_typegen_types_num; i++)
+    if (!strcasecmp (name, tst_typegen_types[i].name))
+      tst_typegen_error (&p, "name of datatype already in use");
+
+  tst_typegen_type (&p, &node, 0);
+  tst_typegen_skip (&p);
+  if (*p.pos != '\0')
+    tst_typegen_error (&p, "unexpected characters after datatype");
+
+  /*
+   * The testsuite frees the registered datatype, so even a plain predefined one gets its own handle.
+   */
+  if (!node.derived)
+    {
+      MPI_CHECK (MPI_Type_contiguous (1, node.type, &node.type));
+      node.derived = 1;
+    }
+  MPI_CHECK (MPI_Type_get_extent (node.type, &lb, &node.extent));
+  if (lb != 0)
+    tst_typegen_error (&p, "lower bound of datatype must be 0");
+  if (node.extent <= 0 || node.extent > INT_MAX)
+    tst_typegen_error (&p, "extent of datatype out of range");
+  if (node.leaves_num == 0)
+    tst_typegen_error (&p, "datatype has no data");
+  tst_typegen_check (&p, &node);
+  MPI_CHECK (MPI_Type_commit (&node.type));
+
+  if (tst_typegen_types_num == tst_typegen_types_max)
+    {
+      tst_typegen_types_max = (tst_typegen_types_max == 0) ? 8 : 2 * tst_typegen_types_max;
+      tst_typegen_types = realloc (tst_typegen_types, tst_typegen_types_max * sizeof (struct tst_typegen_type));
+      if (tst_typegen_types == NULL)
+        ERROR (errno, "realloc");
+    }
+  gen = &tst_typegen_types[tst_typegen_types_num++];
+  strcpy (gen->name, name);
+  gen->mpi_datatype = node.type;
+  gen->extent = node.extent;
+  gen->leaves_num = node.leaves_num;
+  gen->leaf_disps = node.disps;
+  gen->leaf_types = node.bases;
+
+  tst_output_printf (DEBUG_LOG, TST_REPORT_MAX, "(Rank:%d) Generated datatype %s from \"%s\": extent %ld, %d basic elements\n",
+                     tst_global_rank, gen->name, item, (long) gen->extent, gen->leaves_num);
+}
+
+
+/*
+ * Trim the item in place and add it, unless it is empty.
+ */
+static void tst_typegen_additem (char * item)
+{
+  char * end = item + strlen (item);
+
+  while (isspace ((unsigned char) *item))
+    item++;
+  while (end > item && isspace ((unsigned char) end[-1]))
+    *--end = '\0';
+  if (*item != '\0')
+    tst_typegen_add (item);
+}
+
+
+static void tst_typegen_readfile (const char * filename)
+{
+  char line[TST_TYPEGEN_LINE_MAX];
+  char buffer[256];
+  FILE * file;
+
+  if ((file = fopen (filename, "r")) == NULL)
+    {
+      snprintf (buffer, sizeof (buffer), "Could not open datatype spec file %s", filename);
+      ERROR (errno, buffer);
+    }
+  while (fgets (line, sizeof (line), file) != NULL)
+    {
+      if (strchr (line, '\n') == NULL && !feof (file))
+        {
+          snprintf (buffer, sizeof (buffer), "Line too long in datatype spec file %s", filename);
+          ERROR (EINVAL, buffer);
+        }
+      line[strcspn (line, "#\n")] = '\0';
+      tst_typegen_additem (line);
+    }
+  fclose (file);
+}
+
+
+int tst_typegen_parse (const char * specs)
+{
+  char * str;
+  char * item;
+  char * next;
+
+  if ((str = strdup (specs)) == NULL)
+    ERROR (errno, "strdup");
+  for (item = str; item != NULL; item = next)
+    {
+      if ((next = strchr (item, ';')) != NULL)
+        *next++ = '\0';
+      while (isspace ((unsigned char) *item))
+        item++;
+      if (*item == '@')
+        {
+          item[strcspn (item, " \t\n")] = '\0';
+          tst_typegen_readfile (item + 1);
+        }
+      else
+        tst_typegen_additem (item);
+    }
+  free (str);
+  return tst_typegen_types_num;
+}
+
+
+int tst_typegen_num (void)
+{
+  return tst_typegen_types_num;
+}
+
+
+const struct tst_typegen_type * tst_typegen_get (int i)
+{
+  if (i < 0 || i >= tst_typegen_types_num)
+    return NULL;
+  return &tst_typegen_types[i];
+}
+
+
+int tst_typegen_cleanup (void)
+{
+  int i;
+  for (i = 0; i < tst_typegen_types_num; i++)
+    {
+      free (tst_typegen_types[i].leaf_disps);
+      free (tst_typegen_types[i].leaf_types);
+    }
+  free (tst_typegen_types);
+  tst_typegen_types = NULL;
+  tst_typegen_types_num = 0;
+  tst_typegen_types_max = 0;
+  return 0;
+}
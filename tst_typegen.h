@@ -0,0 +1,63 @@
+#ifndef TST_TYPEGEN_H_
+#define TST_TYPEGEN_H_
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+
+
+/** \brief Derived datatype built from a spec, together with its basic elements */
+struct tst_typegen_type {
+  char name[TST_DESCRIPTION_LEN];
+  MPI_Datatype mpi_datatype;   /* Committed datatype with lower bound 0 */
+  MPI_Aint extent;
+  int leaves_num;              /* Number of basic elements in the order of the type map */
+  MPI_Aint * leaf_disps;       /* Displacement of every basic element */
+  MPI_Datatype * leaf_types;   /* Predefined datatype of every basic element */
+};
+
+/** \brief Parse and build the derived datatypes of a list of specs
+ *
+ * The list is separated by ';', every entry being a spec, optionally
+ * preceded by "name=", or @FILE with one spec per line ('#' starts
+ * a comment). Unnamed specs are called GENERATED_<n>. A spec is one of
+ *
+ *   char, uchar, schar, byte, short, ushort, int, uint, long, ulong, llong, float, double
+ *   contig(count, T)
+ *   vector(count, blocklen, stride, T)             stride in extents of T
+ *   hvector(count, blocklen, stride, T)            stride in bytes
+ *   indexed([blocklen:disp, ...], T)               displacements in extents of T
+ *   hindexed([blocklen:disp, ...], T)              displacements in bytes
+ *   struct([blocklen*]T@disp, ...)                 displacements in bytes
+ *   subarray([sizes], [subsizes], [starts], T)     C order
+ *   resized(lb, extent, T)
+ *
+ * nested to any depth, numbers may carry the suffixes K, M and G.
+ * E.g. "halo=vector(64,1,66,double); particle=resized(0,64,struct(3*double@0,3*double@24,int@48))".
+ *
+ * The basic elements of a datatype must not overlap and must lie within
+ * [0, extent), such that arrays of the datatype may be received into.
+ *
+ * \param[in] specs  list of specs
+ *
+ * \return number of datatypes built so far
+ */
+int tst_typegen_parse (const char * specs);
+
+/** \brief Get the number of generated datatypes */
+int tst_typegen_num (void);
+
+/** \brief Get a generated datatype
+ *
+ * \param[in] i  index of the generated datatype
+ *
+ * \return the datatype, which stays valid until tst_typegen_cleanup
+ */
+const struct tst_typegen_type * tst_typegen_get (int i);
+
+/** \brief Release the generated datatypes
+ *
+ * The MPI datatypes themselves are freed by tst_type_cleanup, which registered them.
+ */
+int tst_typegen_cleanup (void);
+
+#endif  /* TST_TYPEGEN_H_ */
@@ -0,0 +1,283 @@
+#include "config.h"
+
+#include "tst_typemap.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+
+
+static void tst_typemap_addblock (struct tst_typemap * map, MPI_Aint disp, MPI_Aint len)
+{
+  if (len == 0)
+    return;
+
+  /*
+   * Merge with the previous block, if it ends right here.
+   */
+  if (map->blocks_num > 0 &&
+      map->disps[map->blocks_num - 1] + map->lens[map->blocks_num - 1] == disp)
+    {
+      map->lens[map->blocks_num - 1] += len;
+      map->size += len;
+      return;
+    }
+
+  if (map->blocks_num == map->blocks_max)
+    {
+      map->blocks_max = (map->blocks_max == 0) ? 16 : 2 * map->blocks_max;
+      map->disps = realloc (map->disps, map->blocks_max * sizeof (MPI_Aint));
+      map->lens = realloc (map->lens, map->blocks_max * sizeof (MPI_Aint));
+      if (map->disps == NULL || map->lens == NULL)
+        ERROR (errno, "realloc");
+    }
+  map->disps[map->blocks_num] = disp;
+  map->lens[map->blocks_num] = len;
+  map->blocks_num++;
+  map->size += len;
+}
+
+
+/*
+ * The predefined pair types for MINLOC and MAXLOC may have a gap between their members.
+ */
+#define TST_TYPEMAP_PAIR(c_type)                                                \
+  do {                                                                          \
+    tst_typemap_addblock (map, disp + offsetof (c_type, a), sizeof (((c_type *) 0)->a)); \
+    tst_typemap_addblock (map, disp + offsetof (c_type, b), sizeof (((c_type *) 0)->b)); \
+  } while (0)
+
+static void tst_typemap_addnamed (struct tst_typemap * map, MPI_Datatype type, MPI_Aint disp)
+{
+  int size;
+
+  if (type == MPI_FLOAT_INT)
+    TST_TYPEMAP_PAIR (struct tst_mpi_float_int);
+  else if (type == MPI_DOUBLE_INT)
+    TST_TYPEMAP_PAIR (struct tst_mpi_double_int);
+  else if (type == MPI_LONG_INT)
+    TST_TYPEMAP_PAIR (struct tst_mpi_long_int);
+  else if (type == MPI_SHORT_INT)
+    TST_TYPEMAP_PAIR (struct tst_mpi_short_int);
+  else if (type == MPI_2INT)
+    TST_TYPEMAP_PAIR (struct tst_mpi_2int);
+  else if (type == MPI_LONG_DOUBLE_INT)
+    TST_TYPEMAP_PAIR (struct tst_mpi_long_double_int);
+  else
+    {
+      /*
+       * Markers like MPI_LB and MPI_UB have no data.
+       */
+      MPI_CHECK (MPI_Type_size (type, &size));
+      tst_typemap_addblock (map, disp, size);
+    }
+}
+
+
+static int tst_typemap_addtype (struct tst_typemap * map, MPI_Datatype type, MPI_Aint disp)
+{
+  int num_ints, num_aints, num_types, combiner;
+  int * ints;
+  MPI_Aint * aints;
+  MPI_Datatype * types;
+  MPI_Aint lb, extent;
+  int ret = 0;
+  int i, j;
+
+  MPI_CHECK (MPI_Type_get_envelope (type, &num_ints, &num_aints, &num_types, &combiner));
+  if (combiner == MPI_COMBINER_NAMED)
+    {
+      tst_typemap_addnamed (map, type, disp);
+      return 0;
+    }
+
+  ints = malloc ((num_ints + 1) * sizeof (int));
+  aints = malloc ((num_aints + 1) * sizeof (MPI_Aint));
+  types = malloc ((num_types + 1) * sizeof (MPI_Datatype));
+  if (ints == NULL || aints == NULL || types == NULL)
+    ERROR (errno, "malloc");
+  MPI_CHECK (MPI_Type_get_contents (type, num_ints, num_aints, num_types, ints, aints, types));
+  MPI_CHECK (MPI_Type_get_extent (types[0], &lb, &extent));
+
+  switch (combiner)
+    {
+      case MPI_COMBINER_DUP:
+      case MPI_COMBINER_RESIZED:
+        ret = tst_typemap_addtype (map, types[0], disp);
+        break;
+      case MPI_COMBINER_CONTIGUOUS:
+        for (i = 0; i < ints[0] && ret == 0; i++)
+          ret = tst_typemap_addtype (map, types[0], disp + i * extent);
+        break;
+      case MPI_COMBINER_VECTOR:
+        for (i = 0; i < ints[0]; i++)
+          for (j = 0; j < ints[1] && ret == 0; j++)
+            ret = tst_typemap_addtype (map, types[0], disp + ((MPI_Aint) i * ints[2] + j) * extent);
+        break;
+      case MPI_COMBINER_HVECTOR:
+#if MPI_VERSION < 3
+      case MPI_COMBINER_HVECTOR_INTEGER:
+#endif
+        for (i = 0; i < ints[0]; i++)
+          for (j = 0; j < ints[1] && ret == 0; j++)
+            ret = tst_typemap_addtype (map, types[0], disp + i * aints[0] + j * extent);
+        break;
+      case MPI_COMBINER_INDEXED:
+        for (i = 0; i < ints[0]; i++)
+          for (j = 0; j < ints[1 + i] && ret == 0; j++)
+            ret = tst_typemap_addtype (map, types[0], disp + ((MPI_Aint) ints[1 + ints[0] + i] + j) * extent);
+        break;
+      case MPI_COMBINER_HINDEXED:
+#if MPI_VERSION < 3
+      case MPI_COMBINER_HINDEXED_INTEGER:
+#endif
+        for (i = 0; i < ints[0]; i++)
+          for (j = 0; j < ints[1 + i] && ret == 0; j++)
+            ret = tst_typemap_addtype (map, types[0], disp + aints[i] + j * extent);
+        break;
+      case MPI_COMBINER_INDEXED_BLOCK:
+        for (i = 0; i < ints[0]; i++)
+          for (j = 0; j < ints[1] && ret == 0; j++)
+            ret = tst_typemap_addtype (map, types[0], disp + ((MPI_Aint) ints[2 + i] + j) * extent);
+        break;
+#if MPI_VERSION >= 3
+      case MPI_COMBINER_HINDEXED_BLOCK:
+        for (i = 0; i < ints[0]; i++)
+          for (j = 0; j < ints[1] && ret == 0; j++)
+            ret = tst_typemap_addtype (map, types[0], disp + aints[i] + j * extent);
+        break;
+#endif
+      case MPI_COMBINER_STRUCT:
+#if MPI_VERSION < 3
+      case MPI_COMBINER_STRUCT_INTEGER:
+#endif
+        for (i = 0; i < ints[0]; i++)
+          {
+            MPI_CHECK (MPI_Type_get_extent (types[i], &lb, &extent));
+            for (j = 0; j < ints[1 + i] && ret == 0; j++)
+              ret = tst_typemap_addtype (map, types[i], disp + aints[i] + j * extent);
+          }
+        break;
+      case MPI_COMBINER_SUBARRAY:
+        {
+          const int ndims = ints[0];
+          const int * sizes = &ints[1];
+          const int * subsizes = &ints[1 + ndims];
+          const int * starts = &ints[1 + 2 * ndims];
+          const int order = ints[1 + 3 * ndims];
+          MPI_Aint num = 1;
+          MPI_Aint k;
+
+          /*
+           * Element k of the subarray in the order of the type map, the last
+           * dimension running fastest in C order, the first one in Fortran order.
+           */
+          for (i = 0; i < ndims; i++)
+            num *= subsizes[i];
+          for (k = 0; k < num && ret == 0; k++)
+            {
+              MPI_Aint rest = k;
+              MPI_Aint offset = 0;
+              MPI_Aint stride = 1;
+              for (i = 0; i < ndims; i++)
+                {
+                  const int d = (order == MPI_ORDER_C) ? ndims - 1 - i : i;
+                  offset += (starts[d] + rest % subsizes[d]) * stride;
+                  rest /= subsizes[d];
+                  stride *= sizes[d];
+                }
+              ret = tst_typemap_addtype (map, types[0], disp + offset * extent);
+            }
+        }
+        break;
+      default:
+        /*
+         * Darray and the Fortran types are not needed by the datatypes of the testsuite.
+         */
+        ret = -1;
+        break;
+    }
+
+  /*
+   * Free the derived datatypes returned by MPI_Type_get_contents.
+   */
+  for (i = 0; i < num_types; i++)
+    {
+      MPI_CHECK (MPI_Type_get_envelope (types[i], &num_ints, &num_aints, &j, &combiner));
+      if (combiner != MPI_COMBINER_NAMED)
+        MPI_CHECK (MPI_Type_free (&types[i]));
+    }
+  free (ints);
+  free (aints);
+  free (types);
+  return ret;
+}
+
+
+int tst_typemap_init (struct tst_typemap * map, MPI_Datatype type)
+{
+  MPI_Aint lb;
+
+  memset (map, 0, sizeof (struct tst_typemap));
+  MPI_CHECK (MPI_Type_get_extent (type, &lb, &map->extent));
+  if (tst_typemap_addtype (map, type, 0) != 0)
+    {
+      tst_typemap_free (map);
+      return -1;
+    }
+  return 0;
+}
+
+
+int tst_typemap_free (struct tst_typemap * map)
+{
+  free (map->disps);
+  free (map->lens);
+  memset (map, 0, sizeof (struct tst_typemap));
+  return 0;
+}
+
+
+MPI_Aint tst_typemap_gather (const struct tst_typemap * map, const char * buffer, int count, char * packed)
+{
+  const char * const packed_start = packed;
+  int i, j;
+
+  if (map->blocks_num == 1 && map->disps[0] == 0 && map->lens[0] == map->extent)
+    {
+      memcpy (packed, buffer, (size_t) count * map->extent);
+      return (MPI_Aint) count * map->extent;
+    }
+
+  for (i = 0; i < count; i++, buffer += map->extent)
+    for (j = 0; j < map->blocks_num; j++)
+      {
+        memcpy (packed, buffer + map->disps[j], map->lens[j]);
+        packed += map->lens[j];
+      }
+  return packed - packed_start;
+}
+
+
+MPI_Aint tst_typemap_scatter (const struct tst_typemap * map, const char * packed, int count, char * buffer)
+{
+  const char * const packed_start = packed;
+  int i, j;
+
+  if (map->blocks_num == 1 && map->disps[0] == 0 && map->lens[0] == map->extent)
+    {
+      memcpy (buffer, packed, (size_t) count * map->extent);
+      return (MPI_Aint) count * map->extent;
+    }
+
+  for (i = 0; i < count; i++, buffer += map->extent)
+    for (j = 0; j < map->blocks_num; j++)
+      {
+        memcpy (buffer + map->disps[j], packed, map->lens[j]);
+        packed += map->lens[j];
+      }
+  return packed - packed_start;
+}
@@ -0,0 +1,56 @@
+#ifndef TST_TYPEMAP_H_
+#define TST_TYPEMAP_H_
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+
+
+/** \brief Layout of a datatype as a list of contiguous blocks of bytes in the order of its type map
+ *
+ * Consecutive blocks adjacent in memory are merged, so that a contiguous
+ * datatype consists of a single block covering its extent.
+ */
+struct tst_typemap {
+  MPI_Aint extent;       /* Extent of the datatype, the stride between two elements */
+  MPI_Aint size;         /* Number of bytes of data of one element */
+  int blocks_num;
+  int blocks_max;
+  MPI_Aint * disps;      /* Displacement of every block relative to the start of the buffer */
+  MPI_Aint * lens;       /* Length of every block in bytes */
+};
+
+/** \brief Flatten a datatype into its blocks using MPI_Type_get_envelope and MPI_Type_get_contents
+ *
+ * \param[out] map   layout of the datatype
+ * \param[in]  type  datatype to be flattened
+ *
+ * \return 0 on success, -1 if the datatype was built by an unsupported constructor
+ */
+int tst_typemap_init (struct tst_typemap * map, MPI_Datatype type);
+
+/** \brief Release the blocks of a layout */
+int tst_typemap_free (struct tst_typemap * map);
+
+/** \brief Copy the data of count elements into a contiguous buffer, block by block with memcpy
+ *
+ * \param[in]  map     layout of the datatype
+ * \param[in]  buffer  elements laid out according to the datatype
+ * \param[in]  count   number of elements
+ * \param[out] packed  contiguous buffer of at least count * map->size bytes
+ *
+ * \return number of bytes copied
+ */
+MPI_Aint tst_typemap_gather (const struct tst_typemap * map, const char * buffer, int count, char * packed);
+
+/** \brief Copy the data of count elements from a contiguous buffer, the inverse of tst_typemap_gather
+ *
+ * \param[in]  map     layout of the datatype
+ * \param[in]  packed  contiguous buffer of count * map->size bytes
+ * \param[in]  count   number of elements
+ * \param[out] buffer  elements laid out according to the datatype
+ *
+ * \return number of bytes copied
+ */
+MPI_Aint tst_typemap_scatter (const struct tst_typemap * map, const char * packed, int count, char * buffer);
+
+#endif  /* TST_TYPEMAP_H_ */
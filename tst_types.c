@@ -20,6 +20,9 @@
 #endif
 #include <mpi.h>
 #include "mpi_test_suite.h"
+#include "tst_pool.h"
+#include "tst_typegen.h"
+#include "tst_verify.h"
 
 #ifndef LLONG_MAX
 #   define LLONG_MAX    9223372036854775807LL
@@ -40,13 +43,14 @@
 #define MAX_TYPES 128                   /* One of the largest type_maaings is for MPI_TYPE_MIX_ARRAY */
 #define TYPES_NUM_REPEAT   7
 #define OVERHEAD 8
+#define TST_TYPE_CHUNK (1 << 30)        /* Values per standard array of the large-count arrays */
 
 #define CHECK_ARG(i,ret) do {           \
     if ((i) < 0 || (i) > TST_TYPES_NUM) \
       return (ret);                     \
   } while (0)
 
-#define TST_TYPES_NUM (sizeof (types) / sizeof (types[0]))
+#define TST_TYPES_NUM tst_types_num
 #define TST_TYPES_CLASS_NUM (sizeof (tst_types_class_strings) / sizeof (tst_types_class_strings[0]))
 #define SIZEOF_TYPE_MIX_LB_UB (sizeof(char)+sizeof(short)+sizeof(int)+sizeof(long)+sizeof(float)+sizeof(double))
 
@@ -71,6 +75,7 @@ static const struct tst_type_class tst_types_class_strings [] =
     {"STANDARD_C_TYPES", TST_MPI_STANDARD_C_TYPES},
     {"STRUCT_C_TYPES", TST_MPI_STRUCT_C_TYPES},
     {"ALL_C_TYPES", TST_MPI_ALL_C_TYPES},
+    {"GENERATED_TYPES", TST_MPI_TYPE_GENERATED},
 /*    {"STANDARD_FORTRAN_INT_TYPES", TST_MPI_STANDARD_FORTRAN_INT_TYPES},
     {"STANDARD_FORTRAN_FLOAT_TYPES", TST_MPI_STANDARD_FORTRAN_FLOAT_TYPES},
     {"STANDARD_FORTRAN_COMPLEX_TYPES", TST_MPI_STANDARD_FORTRAN_COMPLEX_TYPES},
@@ -80,6 +85,14 @@ static const struct tst_type_class tst_types_class_strings [] =
   };
 
 
+/*
+ * Basic element of a generated datatype.
+ */
+struct tst_type_leaf {
+  MPI_Aint disp;
+  int type;                     /* Index of the predefined datatype */
+};
+
 struct type {
   MPI_Datatype mpi_datatype;
   char description [TST_DESCRIPTION_LEN];
@@ -88,9 +101,10 @@ struct type {
   tst_uint64 type_class;
   int type_num;
   int type_mapping[MAX_TYPES];
+  struct tst_type_leaf * leaves;        /* Basic elements of generated datatypes, type_num of them */
 };
 
-static struct type types[32] = {
+static struct type tst_types_builtin[32] = {
 /* Standard C Types */
       {MPI_CHAR,              "MPI_CHAR",             0, sizeof (char), TST_MPI_CHAR, 1, {TST_MPI_CHAR}},
       {MPI_UNSIGNED_CHAR,     "MPI_UNSIGNED_CHAR",    0, sizeof (unsigned char), TST_MPI_UNSIGNED_CHAR, 1, {TST_MPI_UNSIGNED_CHAR}},
@@ -186,6 +200,71 @@ static struct type types[32] = {
       {MPI_DATATYPE_NULL,     "",                     0, 0, 0, 0, {TST_MPI_INT}}
 };
 
+/*
+ * The built-in datatypes, followed by the generated ones once registered.
+ */
+static struct type * types = tst_types_builtin;
+static int tst_types_num = sizeof (tst_types_builtin) / sizeof (tst_types_builtin[0]);
+
+
+/*
+ * Append the datatypes of tst_typegen after the num initialized built-in ones,
+ * followed by the last element. Returns the number of datatypes.
+ */
+static int tst_type_register (int num)
+{
+  const int gen_num = tst_typegen_num ();
+  struct type * new_types;
+  int i, j;
+  int k = 0;
+
+  if (gen_num == 0)
+    return num;
+
+  if ((new_types = calloc (num + gen_num + 1, sizeof (struct type))) == NULL)
+    ERROR (errno, "calloc");
+  memcpy (new_types, types, num * sizeof (struct type));
+
+  for (i = 0; i < gen_num; i++)
+    {
+      const struct tst_typegen_type * gen = tst_typegen_get (i);
+      struct type * type = &new_types[num + i];
+
+      for (j = 0; j < num; j++)
+        if (!strcasecmp (gen->name, new_types[j].description))
+          {
+            char buffer[128];
+            sprintf (buffer, "Name of generated datatype %s already in use", gen->name);
+            ERROR (EINVAL, buffer);
+          }
+
+      type->mpi_datatype = gen->mpi_datatype;
+      strcpy (type->description, gen->name);
+      type->lb = 0;
+      type->ub = gen->extent;
+      type->type_class = TST_MPI_TYPE_GENERATED;
+      type->type_num = gen->leaves_num;
+      if ((type->leaves = malloc (gen->leaves_num * sizeof (struct tst_type_leaf))) == NULL)
+        ERROR (errno, "malloc");
+      for (j = 0; j < gen->leaves_num; j++)
+        {
+          if (types[k].mpi_datatype != gen->leaf_types[j])
+            for (k = 0; k < PREDEFINED_DATATYPES; k++)
+              if (types[k].mpi_datatype == gen->leaf_types[j])
+                break;
+          if (k == PREDEFINED_DATATYPES)
+            ERROR (EINVAL, "Internal Error");
+          type->leaves[j].disp = gen->leaf_disps[j];
+          type->leaves[j].type = k;
+        }
+    }
+  new_types[num + gen_num].mpi_datatype = MPI_DATATYPE_NULL;
+
+  types = new_types;
+  tst_types_num = num + gen_num + 1;
+  return num + gen_num;
+}
+
 int tst_type_init (int * num_types)
 {
   int i;
@@ -491,7 +570,7 @@ int tst_type_init (int * num_types)
 #endif
 #endif /* HAVE_MPI2 */
 
-  *num_types = num;
+  *num_types = tst_type_register (num);
   return 0;
 }
 
@@ -500,11 +579,20 @@ int tst_type_cleanup (void)
   int i;
   for (i=PREDEFINED_DATATYPES; i < TST_TYPES_NUM; i++)
     {
+      free (types[i].leaves);
+      types[i].leaves = NULL;
       if (MPI_DATATYPE_NULL == types[i].mpi_datatype)
         continue;
 
       MPI_Type_free (&types[i].mpi_datatype);
     }
+  if (types != tst_types_builtin)
+    {
+      free (types);
+      types = tst_types_builtin;
+      tst_types_num = sizeof (tst_types_builtin) / sizeof (tst_types_builtin[0]);
+    }
+  tst_typegen_cleanup ();
   return 0;
 }
 
@@ -553,18 +641,21 @@ void tst_type_hexdump (const char * text, const char * data, int num)
 
 
 char * tst_type_allocvalues (const int type, const int values_num)
+{
+  return tst_type_allocvalues_count (type, values_num);
+}
+
+char * tst_type_allocvalues_count (const int type, const tst_count values_count)
 {
   char * buffer;
-  int type_size;
+  tst_count size = 0;
 
   CHECK_ARG (type, NULL);
-  type_size = tst_type_gettypesize(type);
+  tst_type_getstandardarray_size (type, values_count, &size);
 
-  buffer = malloc ((values_num+OVERHEAD) * type_size);
-  if (buffer == NULL)
-      ERROR (errno, "malloc");
+  buffer = tst_pool_alloc ((size_t) size);
 
-  memset (buffer, DEFAULT_INIT_BYTE, (values_num+OVERHEAD) * type_size);
+  memset (buffer, DEFAULT_INIT_BYTE, (size_t) size);
   buffer -= tst_type_gettypelb(type);
 
   return buffer;
@@ -575,7 +666,7 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
   CHECK_ARG (type, -1);
 
   buffer += tst_type_gettypelb(type);
-  free (buffer);
+  tst_pool_free (buffer);
 
   return 0;
 }
@@ -607,24 +698,37 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
           }                                                                                      \
 */
 
+/*
+ * The buffers may be misaligned for the C type, by the buffer offset or as
+ * leaves of a generated type: values are built in a typed temporary and copied.
+ */
+#define TST_TYPE_STORE(ptr,c_type,value)                                                         \
+  do {                                                                                           \
+    c_type __store = (value);                                                                    \
+    memcpy ((ptr), &__store, sizeof (c_type));                                                   \
+  } while (0)
+
 #define TST_TYPE_SET(tst_type,c_type,c_type_caps)                                                \
   case tst_type:                                                                                 \
     {                                                                                            \
+      c_type __value;                                                                            \
+      memcpy (&__value, buffer, sizeof (__value));                                               \
       switch (type_set)                                                                          \
       {                                                                                          \
-      case TST_TYPE_SET_ZERO: *(c_type*)buffer = 0; break;                                       \
-      case TST_TYPE_SET_MAX: *(c_type*)buffer = c_type_caps##_MAX; break;                        \
-      case TST_TYPE_SET_MIN: *(c_type*)buffer = c_type_caps##_MIN; break;                        \
+      case TST_TYPE_SET_ZERO: __value = 0; break;                                                \
+      case TST_TYPE_SET_MAX: __value = c_type_caps##_MAX; break;                                 \
+      case TST_TYPE_SET_MIN: __value = c_type_caps##_MIN; break;                                 \
       case TST_TYPE_SET_VALUE:                                                                   \
         if (direct_value > c_type_caps##_MAX) {                                                  \
-          *(c_type*)buffer = c_type_caps##_MAX;                                                  \
+          __value = c_type_caps##_MAX;                                                           \
         } else if (direct_value < c_type_caps##_MIN) {                                           \
-          *(c_type*)buffer = c_type_caps##_MIN;                                                  \
+          __value = c_type_caps##_MIN;                                                           \
         } else {                                                                                 \
-          *(c_type*)buffer = direct_value;                                                       \
+          __value = direct_value;                                                                \
         }                                                                                        \
         break;                                                                                   \
       }                                                                                          \
+      memcpy (buffer, &__value, sizeof (__value));                                               \
       break;                                                                                     \
     }
 
@@ -632,21 +736,24 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
 #define TST_TYPE_SET_UNSIGNED(tst_type,c_type,c_type_caps)                                       \
   case tst_type:                                                                                 \
     {                                                                                            \
+      c_type __value;                                                                            \
+      memcpy (&__value, buffer, sizeof (__value));                                               \
       switch (type_set)                                                                          \
       {                                                                                          \
-      case TST_TYPE_SET_ZERO: *(c_type*)buffer = 0; break;                                       \
-      case TST_TYPE_SET_MAX: *(c_type*)buffer = c_type_caps##_MAX; break;                        \
-      case TST_TYPE_SET_MIN: *(c_type*)buffer = 0; break;                                        \
+      case TST_TYPE_SET_ZERO: __value = 0; break;                                                \
+      case TST_TYPE_SET_MAX: __value = c_type_caps##_MAX; break;                                 \
+      case TST_TYPE_SET_MIN: __value = 0; break;                                                 \
       case TST_TYPE_SET_VALUE:                                                                   \
         if (direct_value > c_type_caps##_MAX) {                                                  \
-          *(c_type*)buffer = c_type_caps##_MAX;                                                  \
+          __value = c_type_caps##_MAX;                                                           \
         } else if (direct_value < c_type_caps##_MIN) {                                           \
-          *(c_type*)buffer = c_type_caps##_MIN;                                                  \
+          __value = c_type_caps##_MIN;                                                           \
         } else {                                                                                 \
-          *(c_type*)buffer = direct_value;                                                       \
+          __value = direct_value;                                                                \
         }                                                                                        \
         break;                                                                                   \
       }                                                                                          \
+      memcpy (buffer, &__value, sizeof (__value));                                               \
       break;                                                                                     \
     }
 
@@ -654,39 +761,42 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
 #define TST_TYPE_SET_STRUCT(tst_type,c_type,c_type_caps)                                         \
   case tst_type:                                                                                 \
     {                                                                                            \
+      c_type __value;                                                                            \
+      memcpy (&__value, buffer, sizeof (__value));                                               \
       switch (type_set)                                                                          \
       {                                                                                          \
       case TST_TYPE_SET_ZERO:                                                                    \
-        (*(c_type*)buffer).a = 0;                                                                \
-        (*(c_type*)buffer).b = 0;                                                                \
+        __value.a = 0;                                                                           \
+        __value.b = 0;                                                                           \
         break;                                                                                   \
       case TST_TYPE_SET_MAX:                                                                     \
-        (*(c_type*)buffer).a = c_type_caps##_MAX;                                                \
-        (*(c_type*)buffer).b = INT_MAX;                                                          \
+        __value.a = c_type_caps##_MAX;                                                           \
+        __value.b = INT_MAX;                                                                     \
         break;                                                                                   \
       case TST_TYPE_SET_MIN:                                                                     \
-        (*(c_type*)buffer).a = c_type_caps##_MIN;                                                \
-        (*(c_type*)buffer).b = INT_MIN;                                                          \
+        __value.a = c_type_caps##_MIN;                                                           \
+        __value.b = INT_MIN;                                                                     \
         break;                                                                                   \
       case TST_TYPE_SET_VALUE:                                                                   \
         if (direct_value > c_type_caps##_MAX) {                                                  \
-          (*(c_type*)buffer).a = c_type_caps##_MAX;                                              \
+          __value.a = c_type_caps##_MAX;                                                         \
         } else if (direct_value < c_type_caps##_MIN) {                                           \
-          (*(c_type*)buffer).a = c_type_caps##_MIN;                                              \
+          __value.a = c_type_caps##_MIN;                                                         \
         } else {                                                                                 \
-          (*(c_type*)buffer).a = direct_value;                                                   \
+          __value.a = direct_value;                                                              \
         }                                                                                        \
         if (direct_value > INT_MAX) {                                                            \
-          (*(c_type*)buffer).b = INT_MAX;                                                        \
+          __value.b = INT_MAX;                                                                   \
         } else if (direct_value < INT_MIN) {                                                     \
-          (*(c_type*)buffer).b = INT_MIN;                                                        \
+          __value.b = INT_MIN;                                                                   \
         } else {                                                                                 \
-          (*(c_type*)buffer).b = direct_value;                                                   \
+          __value.b = direct_value;                                                              \
         }                                                                                        \
         break;                                                                                   \
       default:                                                                                   \
         return -1;                                                                               \
       }                                                                                          \
+      memcpy (buffer, &__value, sizeof (__value));                                               \
       break;                                                                                     \
     }
 
@@ -694,26 +804,29 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
 #define TST_TYPE_SET_CONTI(tst_type,c_type,c_type_caps)                                          \
   case tst_type:                                                                                 \
     {                                                                                            \
+      c_type __value[7];                                                                         \
       int __i;                                                                                   \
+      memcpy (&__value, buffer, sizeof (__value));                                               \
       switch (type_set)                                                                          \
       {                                                                                          \
       case TST_TYPE_SET_ZERO:                                                                    \
         for(__i=0 ; __i<7 ; __i++)                                                               \
-          ((c_type*)buffer)[__i] = 0;                                                            \
+          __value[__i] = 0;                                                                      \
         break;                                                                                   \
       case TST_TYPE_SET_MAX:                                                                     \
         for(__i=0 ; __i<7 ; __i++)                                                               \
-          ((c_type*)buffer)[__i] = c_type_caps##_MAX;                                            \
+          __value[__i] = c_type_caps##_MAX;                                                      \
         break;                                                                                   \
       case TST_TYPE_SET_MIN:                                                                     \
         for(__i=0 ; __i<7 ; __i++)                                                               \
-          ((c_type*)buffer)[__i] = c_type_caps##_MIN;                                            \
+          __value[__i] = c_type_caps##_MIN;                                                      \
         break;                                                                                   \
       case TST_TYPE_SET_VALUE:                                                                   \
         for(__i=0 ; __i<7 ; __i++)                                                               \
-          ((c_type*)buffer)[__i] =  direct_value;                                                \
+          __value[__i] =  direct_value;                                                          \
         break;                                                                                   \
       }                                                                                          \
+      memcpy (buffer, &__value, sizeof (__value));                                               \
       break;                                                                                     \
     }
 
@@ -721,83 +834,86 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
 #define TST_TYPE_SET_STRUCT_MIX(tst_type,c_type,c_type_caps)                                     \
   case tst_type:                                                                                 \
     {                                                                                            \
+      c_type __value;                                                                            \
+      memcpy (&__value, buffer, sizeof (__value));                                               \
       switch (type_set)                                                                          \
       {                                                                                          \
       case TST_TYPE_SET_ZERO:                                                                    \
-        (*(c_type*)buffer).a = 0;                                                                \
-        (*(c_type*)buffer).b = 0;                                                                \
-        (*(c_type*)buffer).c = 0;                                                                \
-        (*(c_type*)buffer).d = 0;                                                                \
-        (*(c_type*)buffer).e = 0;                                                                \
-        (*(c_type*)buffer).f = 0;                                                                \
-        (*(c_type*)buffer).g.a = 0;                                                              \
-        (*(c_type*)buffer).g.b = 0;                                                              \
-        (*(c_type*)buffer).h.a = 0;                                                              \
-        (*(c_type*)buffer).h.b = 0;                                                              \
-        (*(c_type*)buffer).i.a = 0;                                                              \
-        (*(c_type*)buffer).i.b = 0;                                                              \
-        (*(c_type*)buffer).j.a = 0;                                                              \
-        (*(c_type*)buffer).j.b = 0;                                                              \
-        (*(c_type*)buffer).k.a = 0;                                                              \
-        (*(c_type*)buffer).k.b = 0;                                                              \
+        __value.a = 0;                                                                           \
+        __value.b = 0;                                                                           \
+        __value.c = 0;                                                                           \
+        __value.d = 0;                                                                           \
+        __value.e = 0;                                                                           \
+        __value.f = 0;                                                                           \
+        __value.g.a = 0;                                                                         \
+        __value.g.b = 0;                                                                         \
+        __value.h.a = 0;                                                                         \
+        __value.h.b = 0;                                                                         \
+        __value.i.a = 0;                                                                         \
+        __value.i.b = 0;                                                                         \
+        __value.j.a = 0;                                                                         \
+        __value.j.b = 0;                                                                         \
+        __value.k.a = 0;                                                                         \
+        __value.k.b = 0;                                                                         \
         break;                                                                                   \
         case TST_TYPE_SET_MAX:                                                                   \
-        (*(c_type*)buffer).a = CHAR_MAX;                                                         \
-        (*(c_type*)buffer).b = SHRT_MAX;                                                         \
-        (*(c_type*)buffer).c = INT_MAX;                                                          \
-        (*(c_type*)buffer).d = LONG_MAX;                                                         \
-        (*(c_type*)buffer).e = FLT_MAX;                                                          \
-        (*(c_type*)buffer).f = DBL_MAX;                                                          \
-        (*(c_type*)buffer).g.a = FLT_MAX;                                                        \
-        (*(c_type*)buffer).g.b = INT_MAX;                                                        \
-        (*(c_type*)buffer).h.a = DBL_MAX;                                                        \
-        (*(c_type*)buffer).h.b = INT_MAX;                                                        \
-        (*(c_type*)buffer).i.a = LONG_MAX;                                                       \
-        (*(c_type*)buffer).i.b = INT_MAX;                                                        \
-        (*(c_type*)buffer).j.a = SHRT_MAX;                                                       \
-        (*(c_type*)buffer).j.b = INT_MAX;                                                        \
-        (*(c_type*)buffer).k.a = INT_MAX;                                                        \
-        (*(c_type*)buffer).k.b = INT_MAX;                                                        \
+        __value.a = CHAR_MAX;                                                                    \
+        __value.b = SHRT_MAX;                                                                    \
+        __value.c = INT_MAX;                                                                     \
+        __value.d = LONG_MAX;                                                                    \
+        __value.e = FLT_MAX;                                                                     \
+        __value.f = DBL_MAX;                                                                     \
+        __value.g.a = FLT_MAX;                                                                   \
+        __value.g.b = INT_MAX;                                                                   \
+        __value.h.a = DBL_MAX;                                                                   \
+        __value.h.b = INT_MAX;                                                                   \
+        __value.i.a = LONG_MAX;                                                                  \
+        __value.i.b = INT_MAX;                                                                   \
+        __value.j.a = SHRT_MAX;                                                                  \
+        __value.j.b = INT_MAX;                                                                   \
+        __value.k.a = INT_MAX;                                                                   \
+        __value.k.b = INT_MAX;                                                                   \
         break;                                                                                   \
         case TST_TYPE_SET_MIN:                                                                   \
-        (*(c_type*)buffer).a = CHAR_MIN;                                                         \
-        (*(c_type*)buffer).b = SHRT_MIN;                                                         \
-        (*(c_type*)buffer).c = INT_MIN;                                                          \
-        (*(c_type*)buffer).d = LONG_MIN;                                                         \
-        (*(c_type*)buffer).e = FLT_MIN;                                                          \
-        (*(c_type*)buffer).f = DBL_MIN;                                                          \
-        (*(c_type*)buffer).g.a = FLT_MIN;                                                        \
-        (*(c_type*)buffer).g.b = INT_MIN;                                                        \
-        (*(c_type*)buffer).h.a = DBL_MIN;                                                        \
-        (*(c_type*)buffer).h.b = INT_MIN;                                                        \
-        (*(c_type*)buffer).i.a = LONG_MIN;                                                       \
-        (*(c_type*)buffer).i.b = INT_MIN;                                                        \
-        (*(c_type*)buffer).j.a = SHRT_MIN;                                                       \
-        (*(c_type*)buffer).j.b = INT_MIN;                                                        \
-        (*(c_type*)buffer).k.a = INT_MIN;                                                        \
-        (*(c_type*)buffer).k.b = INT_MIN;                                                        \
+        __value.a = CHAR_MIN;                                                                    \
+        __value.b = SHRT_MIN;                                                                    \
+        __value.c = INT_MIN;                                                                     \
+        __value.d = LONG_MIN;                                                                    \
+        __value.e = FLT_MIN;                                                                     \
+        __value.f = DBL_MIN;                                                                     \
+        __value.g.a = FLT_MIN;                                                                   \
+        __value.g.b = INT_MIN;                                                                   \
+        __value.h.a = DBL_MIN;                                                                   \
+        __value.h.b = INT_MIN;                                                                   \
+        __value.i.a = LONG_MIN;                                                                  \
+        __value.i.b = INT_MIN;                                                                   \
+        __value.j.a = SHRT_MIN;                                                                  \
+        __value.j.b = INT_MIN;                                                                   \
+        __value.k.a = INT_MIN;                                                                   \
+        __value.k.b = INT_MIN;                                                                   \
         break;                                                                                   \
       case TST_TYPE_SET_VALUE:                                                                   \
-        (*(c_type*)buffer).a = direct_value;                                                     \
-        (*(c_type*)buffer).b = direct_value;                                                     \
-        (*(c_type*)buffer).c = direct_value;                                                     \
-        (*(c_type*)buffer).d = direct_value;                                                     \
-        (*(c_type*)buffer).e = direct_value;                                                     \
-        (*(c_type*)buffer).f = direct_value;                                                     \
-        (*(c_type*)buffer).g.a = direct_value;                                                   \
-        (*(c_type*)buffer).g.b = direct_value;                                                   \
-        (*(c_type*)buffer).h.a = direct_value;                                                   \
-        (*(c_type*)buffer).h.b = direct_value;                                                   \
-        (*(c_type*)buffer).i.a = direct_value;                                                   \
-        (*(c_type*)buffer).i.b = direct_value;                                                   \
-        (*(c_type*)buffer).j.a = direct_value;                                                   \
-        (*(c_type*)buffer).j.b = direct_value;                                                   \
-        (*(c_type*)buffer).k.a = direct_value;                                                   \
-        (*(c_type*)buffer).k.b = direct_value;                                                   \
+        __value.a = direct_value;                                                                \
+        __value.b = direct_value;                                                                \
+        __value.c = direct_value;                                                                \
+        __value.d = direct_value;                                                                \
+        __value.e = direct_value;                                                                \
+        __value.f = direct_value;                                                                \
+        __value.g.a = direct_value;                                                              \
+        __value.g.b = direct_value;                                                              \
+        __value.h.a = direct_value;                                                              \
+        __value.h.b = direct_value;                                                              \
+        __value.i.a = direct_value;                                                              \
+        __value.i.b = direct_value;                                                              \
+        __value.j.a = direct_value;                                                              \
+        __value.j.b = direct_value;                                                              \
+        __value.k.a = direct_value;                                                              \
+        __value.k.b = direct_value;                                                              \
         break;                                                                                   \
       default:                                                                                   \
       return -1;                                                                                 \
       }                                                                                          \
+      memcpy (buffer, &__value, sizeof (__value));                                               \
       break;                                                                                     \
     }
 
@@ -805,52 +921,55 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
 #define TST_TYPE_SET_STRUCT_MIX_ARRAY(tst_type,c_type,c_type_caps)                               \
   case tst_type:                                                                                 \
     {                                                                                            \
+      c_type __value;                                                                            \
+      memcpy (&__value, buffer, sizeof (__value));                                               \
       switch (type_set)                                                                          \
       {                                                                                          \
       int __i;                                                                                   \
       case TST_TYPE_SET_ZERO:                                                                    \
       for (__i=0; __i < TST_MPI_TYPE_MIX_ARRAY_NUM; __i++) {                                     \
-        ((*(c_type*)buffer).a)[__i] = 0;                                                         \
-        ((*(c_type*)buffer).b)[__i] = 0;                                                         \
-        ((*(c_type*)buffer).c)[__i] = 0;                                                         \
-        ((*(c_type*)buffer).d)[__i] = 0;                                                         \
-        ((*(c_type*)buffer).e)[__i] = 0;                                                         \
-        ((*(c_type*)buffer).f)[__i] = 0;                                                         \
+        (__value.a)[__i] = 0;                                                                    \
+        (__value.b)[__i] = 0;                                                                    \
+        (__value.c)[__i] = 0;                                                                    \
+        (__value.d)[__i] = 0;                                                                    \
+        (__value.e)[__i] = 0;                                                                    \
+        (__value.f)[__i] = 0;                                                                    \
       }                                                                                          \
       break;                                                                                     \
       case TST_TYPE_SET_MAX:                                                                     \
       for(__i=0; __i < TST_MPI_TYPE_MIX_ARRAY_NUM; __i++){                                       \
-        ((*(c_type*)buffer).a)[__i] = CHAR_MAX;                                                  \
-        ((*(c_type*)buffer).b)[__i] = SHRT_MAX;                                                  \
-        ((*(c_type*)buffer).c)[__i] = INT_MAX;                                                   \
-        ((*(c_type*)buffer).d)[__i] = LONG_MAX;                                                  \
-        ((*(c_type*)buffer).e)[__i] = FLT_MAX;                                                   \
-        ((*(c_type*)buffer).f)[__i] = DBL_MAX;                                                   \
+        (__value.a)[__i] = CHAR_MAX;                                                             \
+        (__value.b)[__i] = SHRT_MAX;                                                             \
+        (__value.c)[__i] = INT_MAX;                                                              \
+        (__value.d)[__i] = LONG_MAX;                                                             \
+        (__value.e)[__i] = FLT_MAX;                                                              \
+        (__value.f)[__i] = DBL_MAX;                                                              \
       }                                                                                          \
       break;                                                                                     \
       case TST_TYPE_SET_MIN:                                                                     \
       for(__i=0; __i < TST_MPI_TYPE_MIX_ARRAY_NUM; __i++) {                                      \
-        ((*(c_type*)buffer).a)[__i] = CHAR_MIN;                                                  \
-        ((*(c_type*)buffer).b)[__i] = SHRT_MIN;                                                  \
-        ((*(c_type*)buffer).c)[__i] = INT_MIN;                                                   \
-        ((*(c_type*)buffer).d)[__i] = LONG_MIN;                                                  \
-        ((*(c_type*)buffer).e)[__i] = FLT_MIN;                                                   \
-        ((*(c_type*)buffer).f)[__i] = DBL_MIN;                                                   \
+        (__value.a)[__i] = CHAR_MIN;                                                             \
+        (__value.b)[__i] = SHRT_MIN;                                                             \
+        (__value.c)[__i] = INT_MIN;                                                              \
+        (__value.d)[__i] = LONG_MIN;                                                             \
+        (__value.e)[__i] = FLT_MIN;                                                              \
+        (__value.f)[__i] = DBL_MIN;                                                              \
       }                                                                                          \
       break;                                                                                     \
       case TST_TYPE_SET_VALUE:                                                                   \
       for(__i=0; __i < TST_MPI_TYPE_MIX_ARRAY_NUM; __i++) {                                      \
-        ((*(c_type*)buffer).a)[__i] = direct_value;                                              \
-        ((*(c_type*)buffer).b)[__i] = direct_value;                                              \
-        ((*(c_type*)buffer).c)[__i] = direct_value;                                              \
-        ((*(c_type*)buffer).d)[__i] = direct_value;                                              \
-        ((*(c_type*)buffer).e)[__i] = direct_value;                                              \
-        ((*(c_type*)buffer).f)[__i] = direct_value;                                              \
+        (__value.a)[__i] = direct_value;                                                         \
+        (__value.b)[__i] = direct_value;                                                         \
+        (__value.c)[__i] = direct_value;                                                         \
+        (__value.d)[__i] = direct_value;                                                         \
+        (__value.e)[__i] = direct_value;                                                         \
+        (__value.f)[__i] = direct_value;                                                         \
       }                                                                                          \
       break;                                                                                     \
       default:                                                                                   \
       return -1;                                                                                 \
       }                                                                                          \
+      memcpy (buffer, &__value, sizeof (__value));                                               \
       break;                                                                                     \
     }
 
@@ -871,35 +990,35 @@ int tst_type_freevalues (const int type, char * buffer, const int values_num)
       {                                                                                          \
       case TST_TYPE_SET_ZERO:                                                                    \
         buffer[__disp_array[1]]=0;                                                               \
-	*((short*)(&buffer[__disp_array[2]]))= 0;                                                \
-	*((int*)(&buffer[__disp_array[3]]))= 0;                                                  \
-	*((long*)(&buffer[__disp_array[4]]))= 0;                                                 \
-	*((float*)(&buffer[__disp_array[5]]))= 0;                                                \
-	*((double*)(&buffer[__disp_array[6]]))= 0;                                               \
+        TST_TYPE_STORE (&buffer[__disp_array[2]], short, 0);                                     \
+        TST_TYPE_STORE (&buffer[__disp_array[3]], int, 0);                                       \
+        TST_TYPE_STORE (&buffer[__disp_array[4]], long, 0);                                      \
+        TST_TYPE_STORE (&buffer[__disp_array[5]], float, 0);                                     \
+        TST_TYPE_STORE (&buffer[__disp_array[6]], double, 0);                                    \
         break;                                                                                   \
       case TST_TYPE_SET_MAX:                                                                     \
         buffer[__disp_array[1]]=CHAR_MAX;                                                        \
-	*((short*)(&buffer[__disp_array[2]]))= SHRT_MAX;                                         \
-	*((int*)(&buffer[__disp_array[3]]))= INT_MAX;                                            \
-	*((long*)(&buffer[__disp_array[4]]))= LONG_MAX;                                          \
-	*((float*)(&buffer[__disp_array[5]]))= FLT_MAX;                                          \
-	*((double*)(&buffer[__disp_array[6]]))= DBL_MAX;                                         \
+        TST_TYPE_STORE (&buffer[__disp_array[2]], short, SHRT_MAX);                              \
+        TST_TYPE_STORE (&buffer[__disp_array[3]], int, INT_MAX);                                 \
+        TST_TYPE_STORE (&buffer[__disp_array[4]], long, LONG_MAX);                               \
+        TST_TYPE_STORE (&buffer[__disp_array[5]], float, FLT_MAX);                               \
+        TST_TYPE_STORE (&buffer[__disp_array[6]], double, DBL_MAX);                              \
         break;                                                                                   \
       case TST_TYPE_SET_MIN:                                                                     \
         buffer[__disp_array[1]]=CHAR_MIN;                                                        \
-	*((short*)(&buffer[__disp_array[2]]))= SHRT_MIN;                                         \
-	*((int*)(&buffer[__disp_array[3]]))= INT_MIN;                                            \
-	*((long*)(&buffer[__disp_array[4]]))= LONG_MIN;                                          \
-	*((float*)(&buffer[__disp_array[5]]))= FLT_MIN;                                          \
-	*((double*)(&buffer[__disp_array[6]]))= DBL_MIN;                                         \
+        TST_TYPE_STORE (&buffer[__disp_array[2]], short, SHRT_MIN);                              \
+        TST_TYPE_STORE (&buffer[__disp_array[3]], int, INT_MIN);                                 \
+        TST_TYPE_STORE (&buffer[__disp_array[4]], long, LONG_MIN);                               \
+        TST_TYPE_STORE (&buffer[__disp_array[5]], float, FLT_MIN);                               \
+        TST_TYPE_STORE (&buffer[__disp_array[6]], double, DBL_MIN);                              \
       break;                                                                                     \
       case TST_TYPE_SET_VALUE:                                                                   \
 	buffer[__disp_array[1]]= direct_value;                                                   \
-	*((short*)(&buffer[__disp_array[2]]))= direct_value;                                     \
-	*((int*)(&buffer[__disp_array[3]]))= direct_value;                                       \
-	*((long*)(&buffer[__disp_array[4]]))= direct_value;                                      \
-	*((float*)(&buffer[__disp_array[5]]))= direct_value;                                     \
-	*((double*)(&buffer[__disp_array[6]]))= direct_value;                                    \
+        TST_TYPE_STORE (&buffer[__disp_array[2]], short, direct_value);                          \
+        TST_TYPE_STORE (&buffer[__disp_array[3]], int, direct_value);                            \
+        TST_TYPE_STORE (&buffer[__disp_array[4]], long, direct_value);                           \
+        TST_TYPE_STORE (&buffer[__disp_array[5]], float, direct_value);                          \
+        TST_TYPE_STORE (&buffer[__disp_array[6]], double, direct_value);                         \
       break;                                                                                     \
       default:                                                                                   \
       return -1;                                                                                 \
@@ -983,6 +1102,18 @@ int tst_type_setvalue (int type, char * buffer, int type_set, long long direct_v
       TST_TYPE_SET_STRUCT_MIX_ARRAY (TST_MPI_TYPE_MIX_ARRAY, struct tst_mpi_type_mix_array, NOT_USED);
       TST_TYPE_SET_STRUCT_MIX_LB_UB (TST_MPI_TYPE_MIX_LB_UB, NOT_USED, NOT_USED);
 
+      case TST_MPI_TYPE_GENERATED:
+        {
+          /*
+           * Every basic element gets the value, the gaps keep the DEFAULT_INIT_BYTE set above.
+           */
+          int i;
+          for (i = 0; i < types[type].type_num; i++)
+            tst_type_setvalue (types[type].leaves[i].type, buffer + types[type].leaves[i].disp,
+                               type_set, direct_value);
+          break;
+        }
+
 /*
       TST_TYPE_SET (TST_MPI_COMPLEX
       TST_TYPE_SET (TST_MPI_DOUBLE_COMPLEX
@@ -1002,12 +1133,137 @@ int tst_type_setvalue (int type, char * buffer, int type_set, long long direct_v
   return 0;
 }
 
+/*
+ * Type-specialized kernels for the standard array of the predefined C types
+ * and the derived types consisting of ints only. They produce exactly the
+ * values of tst_type_setvalue, but are written as plain loops over the
+ * C type, which the compiler vectorizes; the values of the elements with
+ * index [2, limit) need no clamping, those from limit on are clamped to MAX.
+ */
+static int tst_type_standardarray_limit (int values_num, int comm_rank, double max)
+{
+  if ((double) comm_rank + values_num - 1 <= max)
+    return values_num;
+  if (max - comm_rank + 1 < 2)
+    return 2;
+  return (int) (max - comm_rank + 1);
+}
+
+#define TST_TYPE_STANDARDARRAY(name,c_type,c_type_caps,repeat)                                   \
+static void tst_type_set_standardarray_##name (c_type * buf, int values_num, int comm_rank)      \
+{                                                                                                \
+  const int limit = tst_type_standardarray_limit (values_num, comm_rank,                         \
+                                                  (double) c_type_caps##_MAX);                   \
+  int i;                                                                                         \
+  int j;                                                                                         \
+  for (j = 0; j < repeat && values_num > 0; j++)                                                 \
+    buf[j] = c_type_caps##_MIN;                                                                  \
+  for (j = 0; j < repeat && values_num > 1; j++)                                                 \
+    buf[repeat + j] = c_type_caps##_MAX;                                                         \
+  for (i = 2; i < limit; i++)                                                                    \
+    for (j = 0; j < repeat; j++)                                                                 \
+      buf[i * repeat + j] = (c_type) (comm_rank + i);                                            \
+  for (i = limit > 2 ? limit : 2; i < values_num; i++)                                           \
+    for (j = 0; j < repeat; j++)                                                                 \
+      buf[i * repeat + j] = c_type_caps##_MAX;                                                   \
+}                                                                                                \
+                                                                                                 \
+static int tst_type_check_standardarray_##name (const c_type * buf, int values_num, int comm_rank) \
+{                                                                                                \
+  const int limit = tst_type_standardarray_limit (values_num, comm_rank,                         \
+                                                  (double) c_type_caps##_MAX);                   \
+  int errors = 0;                                                                                \
+  int i;                                                                                         \
+  int j;                                                                                         \
+  for (j = 0; j < repeat && values_num > 0; j++)                                                 \
+    errors += buf[j] != c_type_caps##_MIN;                                                       \
+  for (j = 0; j < repeat && values_num > 1; j++)                                                 \
+    errors += buf[repeat + j] != c_type_caps##_MAX;                                              \
+  for (i = 2; i < limit; i++)                                                                    \
+    for (j = 0; j < repeat; j++)                                                                 \
+      errors += buf[i * repeat + j] != (c_type) (comm_rank + i);                                 \
+  for (i = limit > 2 ? limit : 2; i < values_num; i++)                                           \
+    for (j = 0; j < repeat; j++)                                                                 \
+      errors += buf[i * repeat + j] != c_type_caps##_MAX;                                        \
+  return errors;                                                                                 \
+}
+
+TST_TYPE_STANDARDARRAY (char, char, CHAR, 1)
+TST_TYPE_STANDARDARRAY (uchar, unsigned char, UCHAR, 1)
+#ifdef HAVE_MPI2
+TST_TYPE_STANDARDARRAY (schar, signed char, SCHAR, 1)
+#endif
+TST_TYPE_STANDARDARRAY (short, short, SHRT, 1)
+TST_TYPE_STANDARDARRAY (ushort, unsigned short, USHRT, 1)
+TST_TYPE_STANDARDARRAY (int, int, INT, 1)
+TST_TYPE_STANDARDARRAY (uint, unsigned int, UINT, 1)
+TST_TYPE_STANDARDARRAY (long, long, LONG, 1)
+TST_TYPE_STANDARDARRAY (ulong, unsigned long, ULONG, 1)
+TST_TYPE_STANDARDARRAY (float, float, FLT, 1)
+TST_TYPE_STANDARDARRAY (double, double, DBL, 1)
+#if defined(HAVE_C_MPI_LONG_LONG_INT)
+TST_TYPE_STANDARDARRAY (llong, long long, LLONG, 1)
+#endif
+TST_TYPE_STANDARDARRAY (int7, int, INT, 7)
+
+#define TST_TYPE_STANDARDARRAY_CASE(tst_type,name,c_type)                                        \
+  case tst_type:                                                                                 \
+    if ((unsigned long) buffer % sizeof (c_type))                                                \
+      return -1;                                                                                 \
+    if (check)                                                                                   \
+      return tst_type_check_standardarray_##name ((const c_type *) buffer, values_num, comm_rank); \
+    tst_type_set_standardarray_##name ((c_type *) buffer, values_num, comm_rank);                \
+    return 0;
+
+/*
+ * Sets (check == 0) or checks the standard array using the kernels above.
+ * Returns -1 if there is no kernel for the type or the buffer is not
+ * suitably aligned, otherwise the number of mismatching values.
+ */
+static int tst_type_standardarray_fast (int type, int values_num, char * buffer, int comm_rank, int check)
+{
+  if (tst_type_gettypelb (type) != 0)
+    return -1;
+
+  switch (types[type].type_class)
+    {
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_CHAR, char, char);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_UNSIGNED_CHAR, uchar, unsigned char);
+#ifdef HAVE_MPI2
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_SIGNED_CHAR, schar, signed char);
+#endif
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_BYTE, char, char);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_SHORT, short, short);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_UNSIGNED_SHORT, ushort, unsigned short);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT, int, int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_UNSIGNED, uint, unsigned int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_LONG, long, long);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_UNSIGNED_LONG, ulong, unsigned long);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_FLOAT, float, float);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_DOUBLE, double, double);
+#if defined(HAVE_C_MPI_LONG_LONG_INT)
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_LONG_LONG, llong, long long);
+#endif
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_PACKED, char, char);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT_CONTI, int7, int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT_VECTOR, int7, int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT_HVECTOR, int7, int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT_INDEXED, int7, int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT_HINDEXED, int7, int);
+      TST_TYPE_STANDARDARRAY_CASE (TST_MPI_INT_STRUCT, int7, int);
+    }
+  return -1;
+}
+
 int tst_type_setstandardarray (int type, int values_num, char * buffer, int comm_rank)
 {
   const int type_size = tst_type_gettypesize (type);
   int i;
   CHECK_ARG (type, -1);
 
+  if (tst_type_standardarray_fast (type, values_num, buffer, comm_rank, 0) == 0)
+    return 0;
+
   if (values_num > 0)
     tst_type_setvalue (type, &(buffer[0*type_size]), TST_TYPE_SET_MIN, 0);
   if (values_num > 1)
@@ -1019,13 +1275,13 @@ int tst_type_setstandardarray (int type, int values_num, char * buffer, int comm
   return 0;
 }
 
-int tst_type_getstandardarray_size (int type, int values_num, MPI_Aint * size)
+int tst_type_getstandardarray_size (int type, tst_count values_count, tst_count * size)
 {
   CHECK_ARG (type, -1);
   if (NULL == size)
     return -1;
 
-  *size  = (values_num+OVERHEAD) * tst_type_gettypesize(type);
+  *size  = (values_count+OVERHEAD) * tst_type_gettypesize(type);
 
   return 0;
 }
@@ -1051,82 +1307,119 @@ int tst_type_cmpvalue (int type, const char * buffer1, const char * buffer2)
           buffer1, buf1, buffer2, buf2, tst_type_gettypelb(type));
   */
   if (tst_type_gettypeclass(type) == TST_MPI_LONG_DOUBLE) {
-      return *((long double*)buffer1) != *((long double*)buffer2);
+      long double value1;
+      long double value2;
+      memcpy (&value1, buffer1, sizeof (long double));
+      memcpy (&value2, buffer2, sizeof (long double));
+      return value1 != value2;
   } else {
       return memcmp (buf1, buf2, tst_type_gettypesize (type));
   }
 }
 
-int tst_type_checkstandardarray (int type, int values_num, char * buffer, int comm_rank)
+/*
+ * Compares the received array as a whole, either by its checksum or against
+ * the cached expected array; both are generated only once per type,
+ * values_num and rank. Returns 0 if the arrays match, -1 if not or if
+ * neither applies.
+ */
+static int tst_type_verifystandardarray (int type, int values_num, const char * buffer, int comm_rank)
 {
-  const int type_size = tst_type_gettypesize (type);
-  int errors = 0;
-  char err[128];
-  char * cmp_value;
-  int i;
-
-  CHECK_ARG (type, -1);
-
-  cmp_value = tst_type_allocvalues (type, 1);
-  tst_type_setvalue (type, cmp_value, TST_TYPE_SET_MIN, 0);
+  const size_t len = (size_t) values_num * tst_type_gettypesize (type);
+  const int lb = tst_type_gettypelb (type);
+  uint32_t expected_crc;
+  char * expected;
+  int ret;
+
+  /* Long doubles are compared by value, ignoring their padding */
+  if (values_num <= 0 || tst_type_gettypeclass (type) == TST_MPI_LONG_DOUBLE)
+    return -1;
 
-  if (values_num > 0 && tst_type_cmpvalue (type, &buffer[0*type_size], cmp_value))
+  if (tst_verify_enabled ())
     {
-      if (tst_report >= TST_REPORT_FULL)
+      if (tst_verify_getchecksum (type, values_num, comm_rank, &expected_crc) != 0)
         {
-          printf ("(Rank:%d) Error in MIN:\n",
-                  tst_global_rank);
-          tst_type_hexdump ("Expected cmp_value", cmp_value, type_size);
-          tst_type_hexdump ("Received buffer", &(buffer[0*type_size]), type_size);
+          expected = tst_type_allocvalues (type, values_num);
+          tst_type_setstandardarray (type, values_num, expected, comm_rank);
+          expected_crc = tst_verify_crc32c (0, expected + lb, len);
+          tst_type_freevalues (type, expected, values_num);
+          tst_verify_addchecksum (type, values_num, comm_rank, expected_crc);
         }
-      errors++;
+      return tst_verify_crc32c (0, buffer + lb, len) == expected_crc ? 0 : -1;
     }
 
-  tst_type_setvalue (type, cmp_value, TST_TYPE_SET_MAX, 0);
-  if (values_num > 1 && tst_type_cmpvalue (type, &buffer[1*type_size], cmp_value))
+  if (!tst_verify_golden_enabled (len))
+    return -1;
+
+  if ((ret = tst_verify_cmpgolden (type, values_num, comm_rank, buffer + lb, len)) < 0)
     {
-      if (tst_report >= TST_REPORT_FULL)
-        {
-          printf ("(Rank:%d) Error in MAX:\n",
-                  tst_global_rank);
-          tst_type_hexdump ("Expected cmp_value", cmp_value, type_size);
-          tst_type_hexdump ("Received buffer", &(buffer[0*type_size]), type_size);
-        }
-      errors++;
+      expected = tst_type_allocvalues (type, values_num);
+      tst_type_setstandardarray (type, values_num, expected, comm_rank);
+      tst_verify_addgolden (type, values_num, comm_rank, expected + lb, len);
+      ret = memcmp (expected + lb, buffer + lb, len) != 0;
+      tst_type_freevalues (type, expected, values_num);
     }
+  return ret == 0 ? 0 : -1;
+}
 
-  for (i = 2; i < values_num; i++)
-    {
-      tst_type_setvalue (type, cmp_value, TST_TYPE_SET_VALUE, comm_rank + i);
+int tst_type_checkstandardarray (int type, int values_num, char * buffer, int comm_rank)
+{
+  char * expected;
+  int errors;
+
+  CHECK_ARG (type, -1);
+
+  /*
+   * Only if values mismatch, the expected array is generated to count and report them.
+   */
+  if (tst_type_verifystandardarray (type, values_num, buffer, comm_rank) == 0)
+    return 0;
+  if (tst_type_standardarray_fast (type, values_num, buffer, comm_rank, 1) == 0)
+    return 0;
+
+  expected = tst_type_allocvalues (type, values_num);
+  tst_type_setstandardarray (type, values_num, expected, comm_rank);
+  errors = tst_verify_mismatch (type, values_num, expected, buffer);
+  tst_type_freevalues (type, expected, values_num);
+  return errors;
+}
 
-      if (tst_type_cmpvalue (type, cmp_value, &(buffer[i*type_size])))
-        {
-          /* struct tst_mpi_float_int * tmp = (struct tst_mpi_float_int*) &(buffer[i*type_size]); */
-          /* ((struct tst_mpi_float_int*)cmp_value)->a, */
-          if (tst_report >= TST_REPORT_FULL)
-            {
-              snprintf (err, sizeof (err), "(Rank:%d) Error at i:%d expected ", tst_global_rank, i);
-              tst_type_hexdump (err, cmp_value, type_size);
 
-              snprintf (err, sizeof (err), "(Rank:%d) Error at i:%d but received ", tst_global_rank, i);
-              tst_type_hexdump (err, &(buffer[i*type_size]), type_size);
-            }
-          errors++;
-        }
 /*
-      else
-        printf ("(Rank:%d) Correct at i:%d cmp_value:%d buffer[%d]:%d\n",
-                tst_global_rank, i,
-                (char)*cmp_value,
-                i*type_size,
-                (char)buffer[i*type_size]);
-*/
-    }
+ * Arrays of more than INT_MAX values are a sequence of standard arrays
+ * of TST_TYPE_CHUNK values each. Every chunk continues the values from its
+ * global index, so that a chunk received in place of another is detected;
+ * the seed is kept low enough for comm_rank + i not to overflow an int.
+ */
+static int tst_type_chunkseed (int comm_rank, tst_count i)
+{
+  return (int) (((tst_count) comm_rank + i) % (INT_MAX - TST_TYPE_CHUNK));
+}
 
-  tst_type_freevalues (type, cmp_value, 1);
-  return errors;
+int tst_type_setstandardarray_count (int type, tst_count values_count, char * buffer, int comm_rank)
+{
+  const int type_size = tst_type_gettypesize (type);
+  tst_count i;
+  CHECK_ARG (type, -1);
+
+  for (i = 0; i < values_count; i += TST_TYPE_CHUNK)
+    tst_type_setstandardarray (type, (int) MIN (values_count - i, TST_TYPE_CHUNK),
+                               &(buffer[i*type_size]), tst_type_chunkseed (comm_rank, i));
+  return 0;
 }
 
+int tst_type_checkstandardarray_count (int type, tst_count values_count, char * buffer, int comm_rank)
+{
+  const int type_size = tst_type_gettypesize (type);
+  int errors = 0;
+  tst_count i;
+  CHECK_ARG (type, -1);
+
+  for (i = 0; i < values_count; i += TST_TYPE_CHUNK)
+    errors += tst_type_checkstandardarray (type, (int) MIN (values_count - i, TST_TYPE_CHUNK),
+                                           &(buffer[i*type_size]), tst_type_chunkseed (comm_rank, i));
+  return errors;
+}
 
 static int tst_type_gettypelb (int type)
 {
@@ -0,0 +1,191 @@
+#include "config.h"
+
+#include "tst_values.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <ctype.h>
+
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+
+
+struct tst_values_entry {
+  long long num;   /* Number of values, respectively of bytes */
+  int bytes;       /* Whether num is given in bytes */
+};
+
+static struct tst_values_entry * tst_values = NULL;
+static int tst_values_num = 0;
+static int tst_values_max = 0;
+
+
+static void tst_values_add (long long num, int bytes)
+{
+  if (tst_values_num == tst_values_max)
+    {
+      tst_values_max = (tst_values_max == 0) ? 32 : 2 * tst_values_max;
+      tst_values = realloc (tst_values, tst_values_max * sizeof (struct tst_values_entry));
+      if (tst_values == NULL)
+        ERROR (errno, "realloc");
+    }
+  tst_values[tst_values_num].num = num;
+  tst_values[tst_values_num].bytes = bytes;
+  tst_values_num++;
+}
+
+
+/*
+ * Parse a size such as 1000, 4K, 64M or 1GB starting at str.
+ * Returns the pointer past the size, sets *bytes if the size has the B suffix.
+ */
+static const char * tst_values_parsesize (const char * str, long long * num, int * bytes)
+{
+  char * end;
+  long long mult = 1;
+
+  if (!isdigit ((unsigned char) *str))
+    ERROR (EINVAL, "Invalid number of values specified");
+
+  errno = 0;
+  *num = strtoll (str, &end, 10);
+  if (errno == ERANGE)
+    ERROR (EINVAL, "Number of values too large");
+  switch (toupper ((unsigned char) *end))
+    {
+      case 'K': mult = 1LL << 10; end++; break;
+      case 'M': mult = 1LL << 20; end++; break;
+      case 'G': mult = 1LL << 30; end++; break;
+    }
+  if (*num > LLONG_MAX / mult)
+    ERROR (EINVAL, "Number of values too large");
+  *num *= mult;
+
+  *bytes = 0;
+  if (toupper ((unsigned char) *end) == 'B')
+    {
+      *bytes = 1;
+      end++;
+    }
+  return end;
+}
+
+
+static void tst_values_parseentry (const char * str)
+{
+  long long start, stop, step = 2;
+  int start_bytes, stop_bytes, step_bytes = 0;
+  int geometric = 1;
+  const char * p;
+
+  p = tst_values_parsesize (str, &start, &start_bytes);
+  if (*p == '\0')
+    {
+      tst_values_add (start, start_bytes);
+      return;
+    }
+  if (*p++ != ':')
+    ERROR (EINVAL, "Invalid number of values specified");
+
+  p = tst_values_parsesize (p, &stop, &stop_bytes);
+  if (*p == ':')
+    {
+      p++;
+      if (*p == 'x' || *p == 'X' || *p == '*')
+        p++;
+      else if (*p == '+')
+        {
+          geometric = 0;
+          p++;
+        }
+      else
+        ERROR (EINVAL, "Invalid step of range of number of values specified");
+      p = tst_values_parsesize (p, &step, &step_bytes);
+    }
+  if (*p != '\0')
+    ERROR (EINVAL, "Invalid number of values specified");
+
+  if (start > stop)
+    ERROR (EINVAL, "Start of range of number of values larger than its end");
+  if (geometric && (start == 0 || step < 2))
+    ERROR (EINVAL, "Geometric range of number of values needs start > 0 and factor >= 2");
+  if (!geometric && step < 1)
+    ERROR (EINVAL, "Arithmetic range of number of values needs step >= 1");
+
+  /*
+   * The range is in bytes, if any of its sizes is.
+   */
+  start_bytes |= stop_bytes | step_bytes;
+  for (;;)
+    {
+      tst_values_add (start, start_bytes);
+      if (geometric ? (start > stop / step) : (start > stop - step))
+        break;
+      start = geometric ? start * step : start + step;
+    }
+}
+
+
+int tst_values_init (const char * str)
+{
+  char * list;
+  char * entry;
+
+  if ((list = strdup (str)) == NULL)
+    ERROR (errno, "strdup");
+
+  tst_values_num = 0;
+  for (entry = strtok (list, ","); entry != NULL; entry = strtok (NULL, ","))
+    tst_values_parseentry (entry);
+  free (list);
+
+  if (tst_values_num == 0)
+    ERROR (EINVAL, "No number of values specified");
+
+  return tst_values_num;
+}
+
+
+int tst_values_cleanup (void)
+{
+  free (tst_values);
+  tst_values = NULL;
+  tst_values_num = 0;
+  tst_values_max = 0;
+  return 0;
+}
+
+
+tst_count tst_values_getcount (int value, int type)
+{
+  long long num;
+  int type_size;
+
+  if (value < 0 || value >= tst_values_num)
+    ERROR (EINVAL, "Index into list of number of values out of range");
+
+  if (!tst_values[value].bytes)
+    return (tst_count) tst_values[value].num;
+
+  /*
+   * Round up, so that at least one value is communicated.
+   */
+  type_size = tst_type_gettypesize (type);
+  if (type_size <= 0)
+    type_size = 1;
+  num = tst_values[value].num / type_size + (tst_values[value].num % type_size != 0);
+  if (num == 0)
+    num = 1;
+  return (tst_count) num;
+}
+
+
+int tst_values_getnum (int value, int type)
+{
+  tst_count count;
+
+  count = tst_values_getcount (value, type);
+  return (count > INT_MAX) ? INT_MAX : (int) count;
+}
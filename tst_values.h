@@ -0,0 +1,46 @@
+#ifndef TST_VALUES_H_
+#define TST_VALUES_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Parse the list of number of values to communicate in tests
+ *
+ * The list is comma-separated, every entry being either a single size or a
+ * range start:end[:xF|:+S], generating the geometric series start, start*F, ...
+ * respectively the arithmetic series start, start+S, ... up to end.
+ * The default step of a range is x2.
+ * Sizes may carry the suffixes K, M and G (powers of 1024); a trailing B
+ * denotes a size in bytes, which is converted to a number of values of
+ * each datatype using tst_type_gettypesize.
+ *
+ * \param[in] str  list of number of values, e.g. "1,10,1:4M:x2,1K:64MB:+1MB"
+ *
+ * \return number of parsed entries
+ */
+int tst_values_init (const char * str);
+
+/** \brief Release the list of number of values */
+int tst_values_cleanup (void);
+
+/** \brief Get the number of values of an entry for the specified datatype
+ *
+ * Entries may exceed INT_MAX; these are only run by the large-count tests.
+ *
+ * \param[in] value  index of the entry in the list of number of values
+ * \param[in] type   datatype the entry is converted for, if given in bytes
+ *
+ * \return number of values of the datatype, at least 1 for entries in bytes
+ */
+tst_count tst_values_getcount (int value, int type);
+
+/** \brief Get the number of values of an entry, limited to INT_MAX
+ *
+ * \param[in] value  index of the entry in the list of number of values
+ * \param[in] type   datatype the entry is converted for, if given in bytes
+ *
+ * \return number of values of the datatype, at most INT_MAX
+ */
+int tst_values_getnum (int value, int type);
+
+#endif  /* TST_VALUES_H_ */
@@ -0,0 +1,529 @@
+#include "config.h"
+
+#include "tst_verify.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+
+
+#define TST_VERIFY_CRC32C_POLY  0x82F63B78   /* Reflected Castagnoli polynomial */
+#define TST_VERIFY_MISMATCH_BYTES  16        /* Bytes shown of the first mismatching value of a range */
+#define TST_VERIFY_DUMP_MAX        16        /* Tuples dumped per rank at most */
+
+#define TST_VERIFY_BUCKETS         1024      /* Buckets of the hash tables of checksums and expected arrays */
+
+struct tst_verify_checksum {
+  struct tst_verify_checksum * next;   /* Next entry of the same bucket */
+  int type;
+  int values_num;
+  int comm_rank;
+  uint32_t crc;
+};
+
+/*
+ * Expected standard array, evicted least recently used first. An array being
+ * compared is referenced and only freed by its last user once evicted.
+ */
+struct tst_verify_golden {
+  struct tst_verify_golden * next;       /* Next entry of the same bucket */
+  struct tst_verify_golden * lru_prev;   /* More recently used entry */
+  struct tst_verify_golden * lru_next;   /* Less recently used entry */
+  int type;
+  int values_num;
+  int comm_rank;
+  size_t len;
+  int refcount;
+  int evicted;
+  char * data;
+};
+
+static int tst_verify_mode = TST_VERIFY_FULL;
+static uint32_t tst_verify_table[8][256];
+static struct tst_verify_checksum * tst_verify_checksums[TST_VERIFY_BUCKETS];
+static struct tst_verify_golden * tst_verify_goldens[TST_VERIFY_BUCKETS];
+static struct tst_verify_golden * tst_verify_golden_mru = NULL;
+static struct tst_verify_golden * tst_verify_golden_lru = NULL;
+static size_t tst_verify_golden_budget = 0;
+static size_t tst_verify_golden_size = 0;
+static pthread_mutex_t tst_verify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int tst_verify_ranges_max = 8;
+static char * tst_verify_dump_prefix = NULL;
+static int tst_verify_dump_num = 0;
+
+/*
+ * Reporting state of the (test, comm, type) tuple being run, shared by its threads.
+ */
+static int tst_verify_tuple_test = -1;
+static int tst_verify_tuple_comm = -1;
+static int tst_verify_tuple_type = -1;
+static int tst_verify_tuple_ranges = 0;    /* Ranges printed for the tuple */
+static int tst_verify_tuple_dumped = 0;    /* Whether the arrays of the tuple were dumped */
+
+
+static void tst_verify_init_table (void)
+{
+  uint32_t crc;
+  int i;
+  int j;
+
+  for (i = 0; i < 256; i++)
+    {
+      crc = i;
+      for (j = 0; j < 8; j++)
+        crc = (crc >> 1) ^ (TST_VERIFY_CRC32C_POLY & (0 - (crc & 1)));
+      tst_verify_table[0][i] = crc;
+    }
+  for (i = 0; i < 256; i++)
+    for (j = 1; j < 8; j++)
+      tst_verify_table[j][i] = (tst_verify_table[j-1][i] >> 8) ^
+        tst_verify_table[0][tst_verify_table[j-1][i] & 0xff];
+}
+
+
+/*
+ * Slicing-by-8: consumes 8 bytes per step using one table lookup per byte.
+ */
+uint32_t tst_verify_crc32c (uint32_t crc, const void * buffer, size_t len)
+{
+  const unsigned char * p = buffer;
+
+  if (tst_verify_table[0][1] == 0)
+    tst_verify_init_table ();
+
+  crc = ~crc;
+  while (len >= 8)
+    {
+      crc ^= (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+      crc = tst_verify_table[7][crc & 0xff] ^
+        tst_verify_table[6][(crc >> 8) & 0xff] ^
+        tst_verify_table[5][(crc >> 16) & 0xff] ^
+        tst_verify_table[4][crc >> 24] ^
+        tst_verify_table[3][p[4]] ^
+        tst_verify_table[2][p[5]] ^
+        tst_verify_table[1][p[6]] ^
+        tst_verify_table[0][p[7]];
+      p += 8;
+      len -= 8;
+    }
+  while (len-- > 0)
+    crc = (crc >> 8) ^ tst_verify_table[0][(crc ^ *p++) & 0xff];
+  return ~crc;
+}
+
+
+int tst_verify_init (int mode, size_t golden_budget)
+{
+  if (mode != TST_VERIFY_FULL && mode != TST_VERIFY_HASH)
+    ERROR (EINVAL, "Unknown verification mode");
+
+  tst_verify_mode = mode;
+  tst_verify_golden_budget = golden_budget;
+  tst_verify_init_table ();
+  return 0;
+}
+
+
+int tst_verify_cleanup (void)
+{
+  struct tst_verify_checksum * checksum;
+  struct tst_verify_golden * golden;
+  int i;
+
+  for (i = 0; i < TST_VERIFY_BUCKETS; i++)
+    {
+      while ((checksum = tst_verify_checksums[i]) != NULL)
+        {
+          tst_verify_checksums[i] = checksum->next;
+          free (checksum);
+        }
+      while ((golden = tst_verify_goldens[i]) != NULL)
+        {
+          tst_verify_goldens[i] = golden->next;
+          free (golden->data);
+          free (golden);
+        }
+    }
+  tst_verify_golden_mru = NULL;
+  tst_verify_golden_lru = NULL;
+  tst_verify_golden_size = 0;
+
+  free (tst_verify_dump_prefix);
+  tst_verify_dump_prefix = NULL;
+  tst_verify_dump_num = 0;
+  tst_verify_tuple_test = tst_verify_tuple_comm = tst_verify_tuple_type = -1;
+  return 0;
+}
+
+
+int tst_verify_enabled (void)
+{
+  return tst_verify_mode == TST_VERIFY_HASH;
+}
+
+
+static unsigned int tst_verify_bucket (int type, int values_num, int comm_rank)
+{
+  unsigned int hash;
+
+  hash = (unsigned int) type * 2654435761u;
+  hash = (hash ^ (unsigned int) values_num) * 2654435761u;
+  hash = (hash ^ (unsigned int) comm_rank) * 2654435761u;
+  return (hash >> 16) % TST_VERIFY_BUCKETS;
+}
+
+
+int tst_verify_getchecksum (int type, int values_num, int comm_rank, uint32_t * crc)
+{
+  struct tst_verify_checksum * checksum;
+  int ret = -1;
+
+  pthread_mutex_lock (&tst_verify_mutex);
+  for (checksum = tst_verify_checksums[tst_verify_bucket (type, values_num, comm_rank)];
+       checksum != NULL; checksum = checksum->next)
+    if (checksum->type == type &&
+        checksum->values_num == values_num &&
+        checksum->comm_rank == comm_rank)
+      {
+        *crc = checksum->crc;
+        ret = 0;
+        break;
+      }
+  pthread_mutex_unlock (&tst_verify_mutex);
+  return ret;
+}
+
+
+int tst_verify_addchecksum (int type, int values_num, int comm_rank, uint32_t crc)
+{
+  const unsigned int bucket = tst_verify_bucket (type, values_num, comm_rank);
+  struct tst_verify_checksum * checksum;
+
+  if ((checksum = malloc (sizeof (struct tst_verify_checksum))) == NULL)
+    ERROR (errno, "malloc");
+  checksum->type = type;
+  checksum->values_num = values_num;
+  checksum->comm_rank = comm_rank;
+  checksum->crc = crc;
+
+  pthread_mutex_lock (&tst_verify_mutex);
+  checksum->next = tst_verify_checksums[bucket];
+  tst_verify_checksums[bucket] = checksum;
+  pthread_mutex_unlock (&tst_verify_mutex);
+  return 0;
+}
+
+
+int tst_verify_golden_enabled (size_t len)
+{
+  return len > 0 && len <= tst_verify_golden_budget;
+}
+
+
+/*
+ * The following helpers have to be called with tst_verify_mutex held.
+ */
+static void tst_verify_golden_unlink_lru (struct tst_verify_golden * golden)
+{
+  if (golden->lru_prev != NULL)
+    golden->lru_prev->lru_next = golden->lru_next;
+  else
+    tst_verify_golden_mru = golden->lru_next;
+  if (golden->lru_next != NULL)
+    golden->lru_next->lru_prev = golden->lru_prev;
+  else
+    tst_verify_golden_lru = golden->lru_prev;
+}
+
+
+static void tst_verify_golden_link_mru (struct tst_verify_golden * golden)
+{
+  golden->lru_prev = NULL;
+  golden->lru_next = tst_verify_golden_mru;
+  if (tst_verify_golden_mru != NULL)
+    tst_verify_golden_mru->lru_prev = golden;
+  else
+    tst_verify_golden_lru = golden;
+  tst_verify_golden_mru = golden;
+}
+
+
+static struct tst_verify_golden * tst_verify_golden_find (int type, int values_num, int comm_rank, size_t len)
+{
+  struct tst_verify_golden * golden;
+
+  for (golden = tst_verify_goldens[tst_verify_bucket (type, values_num, comm_rank)];
+       golden != NULL; golden = golden->next)
+    if (golden->type == type &&
+        golden->values_num == values_num &&
+        golden->comm_rank == comm_rank &&
+        golden->len == len)
+      break;
+  return golden;
+}
+
+
+static void tst_verify_golden_evict (struct tst_verify_golden * golden)
+{
+  struct tst_verify_golden ** prev;
+
+  prev = &tst_verify_goldens[tst_verify_bucket (golden->type, golden->values_num, golden->comm_rank)];
+  while (*prev != golden)
+    prev = &(*prev)->next;
+  *prev = golden->next;
+  tst_verify_golden_unlink_lru (golden);
+  tst_verify_golden_size -= golden->len;
+
+  if (golden->refcount > 0)
+    golden->evicted = 1;
+  else
+    {
+      free (golden->data);
+      free (golden);
+    }
+}
+
+
+int tst_verify_cmpgolden (int type, int values_num, int comm_rank, const char * buffer, size_t len)
+{
+  struct tst_verify_golden * golden;
+  int ret;
+
+  pthread_mutex_lock (&tst_verify_mutex);
+  if ((golden = tst_verify_golden_find (type, values_num, comm_rank, len)) != NULL)
+    {
+      tst_verify_golden_unlink_lru (golden);
+      tst_verify_golden_link_mru (golden);
+      golden->refcount++;
+    }
+  pthread_mutex_unlock (&tst_verify_mutex);
+  if (golden == NULL)
+    return -1;
+
+  /*
+   * Compared without holding the lock, such that threads check their arrays concurrently.
+   */
+  ret = memcmp (golden->data, buffer, len) != 0;
+
+  pthread_mutex_lock (&tst_verify_mutex);
+  if (--golden->refcount == 0 && golden->evicted)
+    {
+      free (golden->data);
+      free (golden);
+    }
+  pthread_mutex_unlock (&tst_verify_mutex);
+  return ret;
+}
+
+
+int tst_verify_addgolden (int type, int values_num, int comm_rank, const char * buffer, size_t len)
+{
+  const unsigned int bucket = tst_verify_bucket (type, values_num, comm_rank);
+  struct tst_verify_golden * golden;
+
+  if (!tst_verify_golden_enabled (len))
+    return -1;
+
+  if ((golden = malloc (sizeof (struct tst_verify_golden))) == NULL ||
+      (golden->data = malloc (len)) == NULL)
+    ERROR (errno, "malloc");
+  memcpy (golden->data, buffer, len);
+  golden->type = type;
+  golden->values_num = values_num;
+  golden->comm_rank = comm_rank;
+  golden->len = len;
+  golden->refcount = 0;
+  golden->evicted = 0;
+
+  pthread_mutex_lock (&tst_verify_mutex);
+  /* Another thread may have added the same array meanwhile */
+  if (tst_verify_golden_find (type, values_num, comm_rank, len) != NULL)
+    {
+      pthread_mutex_unlock (&tst_verify_mutex);
+      free (golden->data);
+      free (golden);
+      return 0;
+    }
+  while (tst_verify_golden_size + len > tst_verify_golden_budget)
+    tst_verify_golden_evict (tst_verify_golden_lru);
+
+  golden->next = tst_verify_goldens[bucket];
+  tst_verify_goldens[bucket] = golden;
+  tst_verify_golden_link_mru (golden);
+  tst_verify_golden_size += len;
+  pthread_mutex_unlock (&tst_verify_mutex);
+  return 0;
+}
+
+
+int tst_verify_setmismatch (int ranges_max, const char * dump_prefix)
+{
+  if (ranges_max < 0)
+    ERROR (EINVAL, "Number of reported ranges of mismatching values must not be negative");
+
+  tst_verify_ranges_max = ranges_max;
+  free (tst_verify_dump_prefix);
+  tst_verify_dump_prefix = NULL;
+  if (dump_prefix != NULL && (tst_verify_dump_prefix = strdup (dump_prefix)) == NULL)
+    ERROR (errno, "strdup");
+  return 0;
+}
+
+
+int tst_verify_settuple (const struct tst_env * env)
+{
+  pthread_mutex_lock (&tst_verify_mutex);
+  if (env->test != tst_verify_tuple_test || env->comm != tst_verify_tuple_comm ||
+      env->type != tst_verify_tuple_type)
+    {
+      tst_verify_tuple_test = env->test;
+      tst_verify_tuple_comm = env->comm;
+      tst_verify_tuple_type = env->type;
+      tst_verify_tuple_ranges = 0;
+      tst_verify_tuple_dumped = 0;
+    }
+  pthread_mutex_unlock (&tst_verify_mutex);
+  return 0;
+}
+
+
+/*
+ * Print the range [first, last] of mismatching values with the bytes of the
+ * first value, starting at its first differing one.
+ */
+static void tst_verify_printrange (int type, int first, int last, const char * expected, const char * received)
+{
+  const int type_size = tst_type_gettypesize (type);
+  const unsigned char * e = (const unsigned char *) expected + (size_t) first * type_size;
+  const unsigned char * r = (const unsigned char *) received + (size_t) first * type_size;
+  char hex_expected[3 * TST_VERIFY_MISMATCH_BYTES + 1];
+  char hex_received[3 * TST_VERIFY_MISMATCH_BYTES + 1];
+  int offset;
+  int i;
+
+  for (offset = 0; offset < type_size - 1 && e[offset] == r[offset]; offset++)
+    ;
+  hex_expected[0] = hex_received[0] = '\0';
+  for (i = 0; i < TST_VERIFY_MISMATCH_BYTES && offset + i < type_size; i++)
+    {
+      sprintf (&hex_expected[3 * i], " %02x", e[offset + i]);
+      sprintf (&hex_received[3 * i], " %02x", r[offset + i]);
+    }
+
+  printf ("(Rank:%d) Mismatch at values %d-%d (%d values), value %d from byte %d: expected%s received%s\n",
+          tst_global_rank, first, last, last - first + 1, first, offset, hex_expected, hex_received);
+}
+
+
+static void tst_verify_writefile (const char * filename, const char * data, size_t len)
+{
+  FILE * file;
+
+  if ((file = fopen (filename, "wb")) == NULL ||
+      fwrite (data, 1, len, file) != len)
+    printf ("(Rank:%d) Could not write %s: %s\n", tst_global_rank, filename, strerror (errno));
+  if (file != NULL)
+    fclose (file);
+}
+
+
+/*
+ * Only the first mismatching array of a tuple is written, and at most
+ * TST_VERIFY_DUMP_MAX in total, so that a broken library does not fill the disk.
+ */
+static void tst_verify_dump (const char * expected, const char * received, size_t len)
+{
+  char * filename;
+  size_t filename_len;
+  int num;
+
+  pthread_mutex_lock (&tst_verify_mutex);
+  num = tst_verify_tuple_dumped ? TST_VERIFY_DUMP_MAX : tst_verify_dump_num;
+  if (num < TST_VERIFY_DUMP_MAX)
+    {
+      tst_verify_dump_num++;
+      tst_verify_tuple_dumped = 1;
+    }
+  pthread_mutex_unlock (&tst_verify_mutex);
+  if (num >= TST_VERIFY_DUMP_MAX)
+    return;
+  if (num == TST_VERIFY_DUMP_MAX - 1)
+    printf ("(Rank:%d) Writing the last of %d dumps of mismatching arrays\n", tst_global_rank, TST_VERIFY_DUMP_MAX);
+
+  filename_len = strlen (tst_verify_dump_prefix) + 64;
+  if ((filename = malloc (filename_len)) == NULL)
+    ERROR (errno, "malloc");
+  snprintf (filename, filename_len, "%s.%d.%d.expected", tst_verify_dump_prefix, tst_global_rank, num);
+  tst_verify_writefile (filename, expected, len);
+  snprintf (filename, filename_len, "%s.%d.%d.received", tst_verify_dump_prefix, tst_global_rank, num);
+  tst_verify_writefile (filename, received, len);
+  printf ("(Rank:%d) Wrote the expected and received arrays to %s.%d.%d.{expected,received}\n",
+          tst_global_rank, tst_verify_dump_prefix, tst_global_rank, num);
+  free (filename);
+}
+
+
+int tst_verify_mismatch (int type, int values_num, const char * expected, const char * received)
+{
+  const int type_size = tst_type_gettypesize (type);
+  const int report = (tst_report >= TST_REPORT_FULL);
+  int errors = 0;
+  int ranges = 0;
+  int ranges_shown;
+  int first = -1;
+  int i;
+
+  /*
+   * The ranges printed count against the tuple, not the single array.
+   */
+  pthread_mutex_lock (&tst_verify_mutex);
+  ranges_shown = tst_verify_ranges_max - tst_verify_tuple_ranges;
+  pthread_mutex_unlock (&tst_verify_mutex);
+  if (ranges_shown < 0)
+    ranges_shown = 0;
+
+  /*
+   * The loop runs one past the end to close the last range.
+   */
+  for (i = 0; i <= values_num; i++)
+    {
+      if (i < values_num &&
+          tst_type_cmpvalue (type, expected + (size_t) i * type_size, received + (size_t) i * type_size))
+        {
+          errors++;
+          if (first < 0)
+            first = i;
+          continue;
+        }
+      if (first < 0)
+        continue;
+      if (report && ranges < ranges_shown)
+        tst_verify_printrange (type, first, i - 1, expected, received);
+      ranges++;
+      first = -1;
+    }
+
+  if (errors == 0)
+    return 0;
+  if (ranges_shown > ranges)
+    ranges_shown = ranges;
+  if (report)
+    {
+      pthread_mutex_lock (&tst_verify_mutex);
+      tst_verify_tuple_ranges += ranges_shown;
+      pthread_mutex_unlock (&tst_verify_mutex);
+      printf ("(Rank:%d) %d of %d values of type %s mismatch in %d ranges",
+              tst_global_rank, errors, values_num, tst_type_getdescription (type), ranges);
+      if (ranges > ranges_shown)
+        printf (", %d ranges not shown", ranges - ranges_shown);
+      printf ("\n");
+    }
+  if (tst_verify_dump_prefix != NULL)
+    tst_verify_dump (expected, received, (size_t) values_num * type_size);
+  return errors;
+}
@@ -0,0 +1,138 @@
+#ifndef TST_VERIFY_H_
+#define TST_VERIFY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mpi_test_suite.h"
+
+
+#define TST_VERIFY_FULL   0   /* Compare every value against the expected one */
+#define TST_VERIFY_HASH   1   /* Compare a checksum of the buffer against the expected one */
+
+/** \brief Select how received standard arrays are verified
+ *
+ * \param[in] mode           TST_VERIFY_FULL or TST_VERIFY_HASH
+ * \param[in] golden_budget  memory in bytes for caching expected arrays, 0 disables the cache
+ *
+ * \return 0 on success
+ */
+int tst_verify_init (int mode, size_t golden_budget);
+
+/** \brief Release the cached checksums and expected arrays */
+int tst_verify_cleanup (void);
+
+/** \brief Compute the CRC32C (Castagnoli) checksum of a buffer
+ *
+ * \param[in] crc     checksum of the preceding data, 0 to start
+ * \param[in] buffer  data to be checksummed
+ * \param[in] len     length of the data in bytes
+ *
+ * \return the updated checksum
+ */
+uint32_t tst_verify_crc32c (uint32_t crc, const void * buffer, size_t len);
+
+/** \brief Check whether hash verification is enabled
+ *
+ * \return 1 if hash verification is enabled, 0 otherwise
+ */
+int tst_verify_enabled (void);
+
+/** \brief Look up the cached checksum of an expected standard array
+ *
+ * \param[in]  type        datatype of the array
+ * \param[in]  values_num  number of values of the array
+ * \param[in]  comm_rank   rank the array was generated for
+ * \param[out] crc         cached checksum
+ *
+ * \return 0 if the checksum was found, -1 otherwise
+ */
+int tst_verify_getchecksum (int type, int values_num, int comm_rank, uint32_t * crc);
+
+/** \brief Cache the checksum of an expected standard array
+ *
+ * \param[in] type        datatype of the array
+ * \param[in] values_num  number of values of the array
+ * \param[in] comm_rank   rank the array was generated for
+ * \param[in] crc         checksum of the array
+ *
+ * \return 0 on success
+ */
+int tst_verify_addchecksum (int type, int values_num, int comm_rank, uint32_t crc);
+
+/** \brief Check whether an expected array of the given size may be cached
+ *
+ * \param[in] len  size of the array in bytes
+ *
+ * \return 1 if the array fits into the memory budget, 0 otherwise
+ */
+int tst_verify_golden_enabled (size_t len);
+
+/** \brief Compare an array against the cached expected standard array
+ *
+ * \param[in] type        datatype of the array
+ * \param[in] values_num  number of values of the array
+ * \param[in] comm_rank   rank the array was generated for
+ * \param[in] buffer      array to be compared
+ * \param[in] len         size of the array in bytes
+ *
+ * \return 0 if the arrays match, 1 if they differ, -1 if no expected array is cached
+ */
+int tst_verify_cmpgolden (int type, int values_num, int comm_rank, const char * buffer, size_t len);
+
+/** \brief Cache an expected standard array
+ *
+ * Evicts the least recently used arrays until the new one fits into the budget.
+ *
+ * \param[in] type        datatype of the array
+ * \param[in] values_num  number of values of the array
+ * \param[in] comm_rank   rank the array was generated for
+ * \param[in] buffer      expected array
+ * \param[in] len         size of the array in bytes
+ *
+ * \return 0 on success, -1 if the array exceeds the budget
+ */
+int tst_verify_addgolden (int type, int values_num, int comm_rank, const char * buffer, size_t len);
+
+/** \brief Select how mismatching values are reported
+ *
+ * \param[in] ranges_max   maximum number of ranges of mismatching values printed per
+ *                         (test, comm, type) tuple
+ * \param[in] dump_prefix  prefix of the files the expected and received arrays with
+ *                         mismatching values are written to, NULL to write none
+ *
+ * \return 0 on success
+ */
+int tst_verify_setmismatch (int ranges_max, const char * dump_prefix);
+
+/** \brief Start reporting the mismatches of a test
+ *
+ * The limits on the reported ranges and dumped arrays are reset whenever the
+ * test, communicator or datatype differs from the previous one.
+ *
+ * \param[in] env  environment of the test
+ *
+ * \return 0 on success
+ */
+int tst_verify_settuple (const struct tst_env * env);
+
+/** \brief Count and report the mismatching values of a received array
+ *
+ * With --report full, consecutive mismatching values are coalesced into
+ * ranges, each printed with its first and last index and the first differing
+ * bytes of its first value, up to the number of ranges set by
+ * tst_verify_setmismatch for the tuple set by tst_verify_settuple. The arrays
+ * are written to the files PREFIX.<rank>.<n>.expected and PREFIX.<rank>.<n>.received,
+ * if a prefix is set, only for the first mismatch of the tuple and for at most
+ * 16 tuples per rank.
+ *
+ * \param[in] type        datatype of the arrays
+ * \param[in] values_num  number of values of the arrays
+ * \param[in] expected    expected array
+ * \param[in] received    received array
+ *
+ * \return number of mismatching values
+ */
+int tst_verify_mismatch (int type, int values_num, const char * expected, const char * received);
+
+#endif  /* TST_VERIFY_H_ */
@@ -0,0 +1,309 @@
+#include "config.h"
+
+#include "tst_watchdog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#ifdef HAVE_EXECINFO_H
+#  include <execinfo.h>
+#endif
+
+#include <mpi.h>
+#include "mpi_test_suite.h"
+#include "tst_output.h"
+#include "tst_threads.h"
+
+
+#define TST_WATCHDOG_SIGNAL      SIGUSR1
+#define TST_WATCHDOG_BACKTRACE   64     /* Maximum depth of the backtrace */
+#define TST_WATCHDOG_GRACE       2      /* Seconds to wait for the backtrace of the hanging thread */
+
+struct tst_watchdog_timeout {
+  char * name;    /* Name of the test or test-class */
+  int timeout;    /* Timeout in seconds */
+};
+
+static int tst_watchdog_timeout_default = 0;
+static struct tst_watchdog_timeout * tst_watchdog_timeouts = NULL;
+static int tst_watchdog_timeouts_num = 0;
+
+static int tst_watchdog_running = 0;
+static int tst_watchdog_thread_level = MPI_THREAD_SINGLE;
+static pthread_t tst_watchdog_thread;
+static pthread_t tst_watchdog_main_thread;
+static pthread_mutex_t tst_watchdog_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tst_watchdog_cond = PTHREAD_COND_INITIALIZER;
+static int tst_watchdog_quit = 0;
+static int tst_watchdog_armed = 0;
+static int tst_watchdog_armed_timeout = 0;
+static struct timespec tst_watchdog_deadline;
+static struct tst_env tst_watchdog_env;
+static volatile sig_atomic_t tst_watchdog_backtrace_done = 0;
+
+
+/*
+ * Executed by the hanging thread; only uses async-signal-safe functions.
+ */
+static void tst_watchdog_signal_handler (int sig)
+{
+#ifdef HAVE_EXECINFO_H
+  void * frames[TST_WATCHDOG_BACKTRACE];
+  int num_frames;
+
+  num_frames = backtrace (frames, TST_WATCHDOG_BACKTRACE);
+  backtrace_symbols_fd (frames, num_frames, STDERR_FILENO);
+#endif
+  (void) sig;
+  tst_watchdog_backtrace_done = 1;
+}
+
+
+/*
+ * Records the timeout and terminates the job. Below MPI_THREAD_MULTIPLE the
+ * watchdog thread may not call MPI_Abort, it exits the process instead and
+ * leaves terminating the other processes to the launcher.
+ */
+static void tst_watchdog_abort (void)
+{
+  tst_test_recordfailure (&tst_watchdog_env);
+  printf ("(Rank:%d) Results until the timeout:\n", tst_global_rank);
+  tst_test_print_failed ();
+  fflush (stdout);
+  fflush (stderr);
+  tst_output_close (DEBUG_LOG);
+
+  if (tst_watchdog_thread_level == MPI_THREAD_MULTIPLE)
+    MPI_Abort (MPI_COMM_WORLD, ETIMEDOUT);
+  _exit (ETIMEDOUT);
+}
+
+
+#ifdef HAVE_EXECINFO_H
+/*
+ * The threads are signalled one after the other, so that their backtraces do not interleave.
+ */
+static void tst_watchdog_backtrace (pthread_t thread, const char * name)
+{
+  int i;
+
+  fprintf (stderr, "(Rank:%d) WATCHDOG: backtrace of the %s:\n", tst_global_rank, name);
+  fflush (stderr);
+  tst_watchdog_backtrace_done = 0;
+  if (pthread_kill (thread, TST_WATCHDOG_SIGNAL) == 0)
+    for (i = 0; i < 10 * TST_WATCHDOG_GRACE && !tst_watchdog_backtrace_done; i++)
+      usleep (100000);
+}
+#endif
+
+
+static void tst_watchdog_expire (void)
+{
+  char name[32];
+  int i;
+
+  fprintf (stderr, "(Rank:%d) WATCHDOG: %s test %s, comm %s, type %s, number of values %d "
+           "did not finish within %d s\n",
+           tst_global_rank,
+           tst_test_getclass_string (tst_watchdog_env.test),
+           tst_test_getdescription (tst_watchdog_env.test),
+           tst_comm_getdescription (tst_watchdog_env.comm),
+           tst_type_getdescription (tst_watchdog_env.type),
+           tst_watchdog_env.values_num, tst_watchdog_armed_timeout);
+  tst_output_printf (DEBUG_LOG, TST_REPORT_SUMMARY, "(Rank:%d) WATCHDOG: test:%d comm:%d type:%d values_num:%d timed out\n",
+                     tst_global_rank, tst_watchdog_env.test, tst_watchdog_env.comm,
+                     tst_watchdog_env.type, tst_watchdog_env.values_num);
+
+#ifdef HAVE_EXECINFO_H
+  tst_watchdog_backtrace (tst_watchdog_main_thread, "main thread");
+  for (i = 0; i < tst_thread_num_threads (); i++)
+    {
+      snprintf (name, sizeof (name), "worker thread %d", i);
+      tst_watchdog_backtrace (tst_thread_get_tid (i), name);
+    }
+#else
+  (void) i;
+  (void) name;
+  fprintf (stderr, "(Rank:%d) WATCHDOG: no backtrace available\n", tst_global_rank);
+#endif
+
+  tst_watchdog_abort ();
+}
+
+
+static int tst_watchdog_expired (void)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_REALTIME, &now);
+  return tst_watchdog_armed &&
+    (now.tv_sec > tst_watchdog_deadline.tv_sec ||
+     (now.tv_sec == tst_watchdog_deadline.tv_sec && now.tv_nsec >= tst_watchdog_deadline.tv_nsec));
+}
+
+
+static void * tst_watchdog_main (void * arg)
+{
+  (void) arg;
+
+  pthread_mutex_lock (&tst_watchdog_mutex);
+  while (!tst_watchdog_quit)
+    {
+      if (!tst_watchdog_armed)
+        pthread_cond_wait (&tst_watchdog_cond, &tst_watchdog_mutex);
+      else if (pthread_cond_timedwait (&tst_watchdog_cond, &tst_watchdog_mutex,
+                                       &tst_watchdog_deadline) == ETIMEDOUT &&
+               tst_watchdog_expired ())
+        {
+          pthread_mutex_unlock (&tst_watchdog_mutex);
+          tst_watchdog_expire ();
+          return NULL;
+        }
+    }
+  pthread_mutex_unlock (&tst_watchdog_mutex);
+  return NULL;
+}
+
+
+static void tst_watchdog_parse (const char * timeouts)
+{
+  char * list;
+  char * entry;
+  char * sep;
+
+  if ((list = strdup (timeouts)) == NULL)
+    ERROR (errno, "strdup");
+
+  for (entry = strtok (list, ","); entry != NULL; entry = strtok (NULL, ","))
+    {
+      if ((sep = strrchr (entry, '=')) == NULL || sep == entry || sep[1] == '\0')
+        ERROR (EINVAL, "Timeouts have to be specified as name=seconds");
+      *sep = '\0';
+
+      tst_watchdog_timeouts = realloc (tst_watchdog_timeouts,
+                                       (tst_watchdog_timeouts_num + 1) * sizeof (struct tst_watchdog_timeout));
+      if (tst_watchdog_timeouts == NULL)
+        ERROR (errno, "realloc");
+      if ((tst_watchdog_timeouts[tst_watchdog_timeouts_num].name = strdup (entry)) == NULL)
+        ERROR (errno, "strdup");
+      tst_watchdog_timeouts[tst_watchdog_timeouts_num].timeout = atoi (sep + 1);
+      if (tst_watchdog_timeouts[tst_watchdog_timeouts_num].timeout < 0)
+        ERROR (EINVAL, "Timeout must not be negative");
+      tst_watchdog_timeouts_num++;
+    }
+  free (list);
+}
+
+
+/*
+ * The timeout of a test takes precedence over the one of its class.
+ */
+static int tst_watchdog_gettimeout (int test)
+{
+  int i;
+
+  for (i = 0; i < tst_watchdog_timeouts_num; i++)
+    if (!strcasecmp (tst_watchdog_timeouts[i].name, tst_test_getdescription (test)))
+      return tst_watchdog_timeouts[i].timeout;
+  for (i = 0; i < tst_watchdog_timeouts_num; i++)
+    if (!strcasecmp (tst_watchdog_timeouts[i].name, tst_test_getclass_string (test)))
+      return tst_watchdog_timeouts[i].timeout;
+  return tst_watchdog_timeout_default;
+}
+
+
+int tst_watchdog_init (int timeout, const char * timeouts)
+{
+  struct sigaction action;
+  int ret;
+
+  if (timeout < 0)
+    ERROR (EINVAL, "Timeout must not be negative");
+  tst_watchdog_timeout_default = timeout;
+  if (timeouts != NULL)
+    tst_watchdog_parse (timeouts);
+
+  if (tst_watchdog_timeout_default == 0 && tst_watchdog_timeouts_num == 0)
+    return 0;
+
+  memset (&action, 0, sizeof (action));
+  action.sa_handler = tst_watchdog_signal_handler;
+  sigemptyset (&action.sa_mask);
+  if (sigaction (TST_WATCHDOG_SIGNAL, &action, NULL) != 0)
+    ERROR (errno, "sigaction");
+
+#if MPI_VERSION >= 2
+  MPI_CHECK (MPI_Query_thread (&tst_watchdog_thread_level));
+#endif
+
+  tst_watchdog_main_thread = pthread_self ();
+  tst_watchdog_quit = 0;
+  tst_watchdog_armed = 0;
+  ret = pthread_create (&tst_watchdog_thread, NULL, tst_watchdog_main, NULL);
+  if (ret != 0)
+    ERROR (ret, "pthread_create");
+  tst_watchdog_running = 1;
+  return 0;
+}
+
+
+int tst_watchdog_cleanup (void)
+{
+  int i;
+
+  if (tst_watchdog_running)
+    {
+      pthread_mutex_lock (&tst_watchdog_mutex);
+      tst_watchdog_quit = 1;
+      pthread_cond_signal (&tst_watchdog_cond);
+      pthread_mutex_unlock (&tst_watchdog_mutex);
+      pthread_join (tst_watchdog_thread, NULL);
+      tst_watchdog_running = 0;
+    }
+
+  for (i = 0; i < tst_watchdog_timeouts_num; i++)
+    free (tst_watchdog_timeouts[i].name);
+  free (tst_watchdog_timeouts);
+  tst_watchdog_timeouts = NULL;
+  tst_watchdog_timeouts_num = 0;
+  return 0;
+}
+
+
+int tst_watchdog_start (const struct tst_env * env)
+{
+  int timeout;
+
+  if (!tst_watchdog_running)
+    return 0;
+  if ((timeout = tst_watchdog_gettimeout (env->test)) == 0)
+    return 0;
+
+  pthread_mutex_lock (&tst_watchdog_mutex);
+  memcpy (&tst_watchdog_env, env, sizeof (struct tst_env));
+  clock_gettime (CLOCK_REALTIME, &tst_watchdog_deadline);
+  tst_watchdog_deadline.tv_sec += timeout;
+  tst_watchdog_armed_timeout = timeout;
+  tst_watchdog_armed = 1;
+  pthread_cond_signal (&tst_watchdog_cond);
+  pthread_mutex_unlock (&tst_watchdog_mutex);
+  return 0;
+}
+
+
+int tst_watchdog_stop (void)
+{
+  if (!tst_watchdog_running)
+    return 0;
+
+  pthread_mutex_lock (&tst_watchdog_mutex);
+  tst_watchdog_armed = 0;
+  pthread_mutex_unlock (&tst_watchdog_mutex);
+  return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef TST_WATCHDOG_H_
+#define TST_WATCHDOG_H_
+
+#include "mpi_test_suite.h"
+
+
+/** \brief Start the watchdog thread
+ *
+ * \param[in] timeout   seconds after which a test is considered hanging, 0 disables the watchdog
+ * \param[in] timeouts  comma-separated list of name=seconds, overriding the timeout
+ *                      for tests or test-classes of the given name, may be NULL
+ *
+ * \return 0 on success
+ */
+int tst_watchdog_init (int timeout, const char * timeouts);
+
+/** \brief Stop the watchdog thread */
+int tst_watchdog_cleanup (void);
+
+/** \brief Arm the watchdog for a test
+ *
+ * If the watchdog is not disarmed with tst_watchdog_stop within the timeout
+ * of the test, the test is recorded as failed, the backtraces of the main and
+ * the worker threads and the results so far are printed and the job is aborted
+ * with MPI_Abort, as a blocked MPI call can neither be cancelled nor skipped.
+ * Below MPI_THREAD_MULTIPLE the main thread is signalled to abort the job.
+ *
+ * \param[in] env  environment of the test to be watched
+ *
+ * \return 0 on success
+ */
+int tst_watchdog_start (const struct tst_env * env);
+
+/** \brief Disarm the watchdog after a test finished */
+int tst_watchdog_stop (void);
+
+#endif  /* TST_WATCHDOG_H_ */